@@ -113,3 +113,148 @@ TEST_CASE("Test 2D hbbox", "[hb]") {
     CHECK(primitives[1]==1);
 
 }
+
+TEST_CASE("Test 3D hbbox queries", "[hb]") {
+    auto rnd = []() { return vec3(rand()/(double)RAND_MAX, rand()/(double)RAND_MAX, rand()/(double)RAND_MAX); };
+    std::vector<BBox3> boxes, queries;
+    for (int i=0; i<3000; i++) {
+        vec3 c = rnd();
+        boxes.push_back({c, c + rnd()*.02});
+    }
+    for (int i=0; i<2500; i++) {
+        vec3 c = rnd();
+        queries.push_back({c, c + rnd()*.05});
+    }
+    HBoxes3 hb(boxes);
+
+    std::vector<int> offset, batch, primitives;
+    hb.intersect_batch(queries, offset, batch);
+    REQUIRE( offset.size()==queries.size()+1 );
+    for (int q=0; q<(int)queries.size(); q++) {
+        std::vector<int> ref;
+        for (int b=0; b<(int)boxes.size(); b++)
+            if (boxes[b].intersect(queries[q])) ref.push_back(b);
+        hb.intersect(queries[q], primitives);
+        std::vector<int> res(batch.begin()+offset[q], batch.begin()+offset[q+1]);
+        CHECK( res==primitives );
+        std::sort(primitives.begin(), primitives.end());
+        CHECK( primitives==ref );
+        int hit = hb.first_hit(queries[q]);
+        CHECK( (hit>=0) == !ref.empty() );
+        if (hit>=0) CHECK( boxes[hit].intersect(queries[q]) );
+    }
+
+    for (int i=0; i<500; i++) {
+        vec3 p = rnd();
+        std::vector<int> ref;
+        for (int b=0; b<(int)boxes.size(); b++)
+            if (boxes[b].contains(p)) ref.push_back(b);
+        hb.contains(p, primitives);
+        std::sort(primitives.begin(), primitives.end());
+        CHECK( primitives==ref );
+        CHECK( hb.any_hit(p) == !ref.empty() );
+    }
+}
+
+TEST_CASE("Test overlapping pairs", "[hb]") {
+    auto rnd = []() { return vec3(rand()/(double)RAND_MAX, rand()/(double)RAND_MAX, rand()/(double)RAND_MAX); };
+    std::vector<BBox3> boxes1, boxes2;
+    for (int i=0; i<1500; i++) {
+        vec3 c = rnd();
+        boxes1.push_back({c, c + rnd()*.05});
+    }
+    for (int i=0; i<700; i++) {
+        vec3 c = rnd();
+        boxes2.push_back({c, c + rnd()*.05});
+    }
+    HBoxes3 hb1(boxes1), hb2(boxes2);
+
+    std::vector<std::pair<int, int>> pairs, ref;
+    overlapping_pairs(hb1, hb2, pairs);
+    for (int i=0; i<(int)boxes1.size(); i++)
+        for (int j=0; j<(int)boxes2.size(); j++)
+            if (boxes1[i].intersect(boxes2[j])) ref.emplace_back(i, j);
+    std::sort(pairs.begin(), pairs.end());
+    CHECK( pairs==ref );
+
+    ref.clear();
+    overlapping_pairs(hb1, pairs);
+    for (int i=0; i<(int)boxes1.size(); i++)
+        for (int j=i+1; j<(int)boxes1.size(); j++)
+            if (boxes1[i].intersect(boxes1[j])) ref.emplace_back(i, j);
+    std::sort(pairs.begin(), pairs.end());
+    CHECK( pairs==ref );
+}
+
+TEST_CASE("Test hbbox refit", "[hb]") {
+    auto rnd = []() { return vec3(rand()/(double)RAND_MAX, rand()/(double)RAND_MAX, rand()/(double)RAND_MAX); };
+    std::vector<BBox3> boxes;
+    for (int i=0; i<2000; i++) {
+        vec3 c = rnd();
+        boxes.push_back({c, c + rnd()*.02});
+    }
+    HBoxes3 hb(boxes);
+
+    auto check = [&]() {
+        for (int q=0; q<200; q++) {
+            vec3 c = rnd();
+            BBox3 query(c, c + rnd()*.05);
+            std::vector<int> primitives, ref;
+            for (int b=0; b<(int)boxes.size(); b++)
+                if (boxes[b].intersect(query)) ref.push_back(b);
+            hb.intersect(query, primitives);
+            std::sort(primitives.begin(), primitives.end());
+            CHECK( primitives==ref );
+        }
+    };
+
+    for (BBox3 &b : boxes) { // small motion: the structure is kept
+        vec3 t = (rnd() - vec3(.5, .5, .5))*.01;
+        b = {b.min + t, b.max + t};
+    }
+    CHECK( !hb.refit(boxes) );
+    check();
+
+    for (BBox3 &b : boxes) { // scrambled boxes: the tree is rebuilt
+        vec3 c = rnd();
+        b = {c, c + rnd()*.02};
+    }
+    CHECK( hb.refit(boxes) );
+    check();
+}
+
+TEST_CASE("Test hbbox Morton build", "[hb]") {
+    std::vector<uint64_t> keys;
+    std::vector<int> values;
+    for (int i=0; i<200000; i++) {
+        keys.push_back((uint64_t(rand())<<20) ^ uint64_t(rand()));
+        values.push_back(i);
+    }
+    std::vector<std::pair<uint64_t, int>> ref;
+    for (int i=0; i<(int)keys.size(); i++) ref.emplace_back(keys[i], i);
+    std::sort(ref.begin(), ref.end()); // values are unique and increasing: same as a stable sort
+    radix_sort(keys, values);
+    bool sorted = true;
+    for (int i=0; i<(int)keys.size(); i++)
+        sorted = sorted && keys[i]==ref[i].first && values[i]==ref[i].second;
+    CHECK( sorted );
+
+    auto rnd = []() { return vec3(rand()/(double)RAND_MAX, rand()/(double)RAND_MAX, rand()/(double)RAND_MAX); };
+    std::vector<BBox3> boxes;
+    for (int i=0; i<3000; i++) {
+        vec3 c = rnd();
+        boxes.push_back({c, c + rnd()*.02});
+    }
+    HBoxes3 hb(boxes, MORTON_SORT);
+    for (int q=0; q<500; q++) {
+        vec3 c = rnd();
+        BBox3 query(c, c + rnd()*.05);
+        std::vector<int> primitives, ref;
+        for (int b=0; b<(int)boxes.size(); b++)
+            if (boxes[b].intersect(query)) ref.push_back(b);
+        hb.intersect(query, primitives);
+        std::sort(primitives.begin(), primitives.end());
+        CHECK( primitives==ref );
+    }
+    CHECK( hb.cost() < 3*HBoxes3(boxes).cost() ); // looser than the recursive sort, but spatially coherent
+}
@@ -23,3 +23,180 @@ TEST_CASE("projection to a 3d triangulated surface", "[nearest]") {
     CHECK( (vec3{1, 0, 0} - static_cast<vec3>(p3)).norm() < 1e-5 );
 }
 
+
+TEST_CASE("ray casting against a 3d triangulated surface", "[raycast]") {
+    Triangles m; // a simple tetrahedron
+    *m.points.data = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {0, 0, 0}};
+    m.facets = {1,3,2, 3,1,0, 2,0,1, 0,2,3};
+
+    BVHTriangles bvh(m);
+
+    RayHit h1 = bvh.first_hit({.1, .1, -1}, {0, 0, 1});
+    REQUIRE( h1.hit() );
+    CHECK( h1.f == 1 );
+    CHECK( std::abs(h1.t-1.) < 1e-12 );
+    CHECK( (static_cast<vec3>(h1) - vec3{.1, .1, 0}).norm() < 1e-12 );
+
+    RayHit h2 = bvh.first_hit({.1, .1, .1}, {1, 1, 1}); // from the inside
+    REQUIRE( h2.hit() );
+    CHECK( h2.f == 2 );
+    CHECK( std::abs(static_cast<vec3>(h2)*vec3{1,1,1} - 1.) < 1e-12 );
+
+    CHECK( !bvh.first_hit({2, 2, 2}, {1, 0, 0}).hit() );
+    CHECK(  bvh.any_hit({.1, .1, -1}, {0, 0, 1}) );
+    CHECK( !bvh.any_hit({.1, .1, -1}, {0, 0, 1}, .5) ); // too short
+
+    std::vector<vec3> orgs, dirs;
+    for (int i=0; i<1000; i++) {
+        orgs.push_back({rand()/(double)RAND_MAX*2-.5, rand()/(double)RAND_MAX*2-.5, -1});
+        dirs.push_back({0, 0, 1});
+    }
+    std::vector<int> facet, hit;
+    std::vector<double> t;
+    bvh.first_hit_batch(orgs, dirs, facet, t);
+    bvh.any_hit_batch(orgs, dirs, hit);
+    for (int r=0; r<1000; r++) {
+        bool inside = orgs[r].x >= 0 && orgs[r].y >= 0 && orgs[r].x + orgs[r].y <= 1;
+        CHECK( (facet[r] >= 0) == inside );
+        CHECK( hit[r] == inside );
+        if (inside) CHECK( std::abs(t[r]-1.) < 1e-12 );
+    }
+}
+
+TEST_CASE("batch projection and signed distance to a 3d triangulated surface", "[nearest]") {
+    Triangles m; // a simple tetrahedron, facets oriented outwards
+    *m.points.data = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {0, 0, 0}};
+    m.facets = {1,3,2, 3,1,0, 2,0,1, 0,2,3};
+
+    BVHTriangles bvh(m, MORTON_SORT);
+    SignedDistance sd(bvh);
+
+    std::vector<vec3> pts;
+    for (int i=0; i<1000; i++)
+        pts.push_back({rand()/(double)RAND_MAX*2-.5, rand()/(double)RAND_MAX*2-.5, rand()/(double)RAND_MAX*2-.5});
+    std::vector<PointOnMesh> nearest;
+    std::vector<double> dist;
+    bvh.nearest_points(pts, nearest);
+    sd.distances(pts, dist);
+
+    for (int i=0; i<1000; i++) {
+        double dmin = std::numeric_limits<double>::max(); // brute force
+        for (int f=0; f<m.nfacets(); f++)
+            dmin = std::min(dmin, (pts[i] - bvh.primitive(f).nearest_point(pts[i])).norm());
+        CHECK( std::abs((pts[i] - static_cast<vec3>(nearest[i])).norm() - dmin) < 1e-12 );
+        bool inside = pts[i].x > 0 && pts[i].y > 0 && pts[i].z > 0 && pts[i].x + pts[i].y + pts[i].z < 1;
+        CHECK( std::abs(std::abs(dist[i]) - dmin) < 1e-12 );
+        CHECK( (dist[i] < 0) == inside );
+    }
+
+    CHECK( std::abs(sd.distance({-1, -1, -1}) - std::sqrt(3.)) < 1e-12 ); // nearest feature is a vertex
+    CHECK( std::abs(sd.distance({.5, .5, -1}) - 1.) < 1e-12 );            // an edge
+    CHECK( std::abs(sd.distance({.1, .1, .1}) + .1) < 1e-12 );            // a facet, from the inside
+}
+
+TEST_CASE("refit of the hierarchy of a deforming surface", "[nearest]") {
+    Triangles m; // a 20x20 grid
+    const int n = 20;
+    m.points.create_points((n+1)*(n+1));
+    for (int j=0; j<=n; j++)
+        for (int i=0; i<=n; i++)
+            m.points[i+j*(n+1)] = {i/double(n), j/double(n), 0};
+    for (int j=0; j<n; j++)
+        for (int i=0; i<n; i++) {
+            int v = i+j*(n+1);
+            m.facets.insert(m.facets.end(), {v, v+1, v+n+2, v, v+n+2, v+n+1});
+        }
+
+    BVHTriangles bvh(m);
+    auto check = [&]() {
+        for (int q=0; q<100; q++) {
+            vec3 p = {rand()/(double)RAND_MAX*1.2-.1, rand()/(double)RAND_MAX*1.2-.1, rand()/(double)RAND_MAX-.5};
+            double dmin = std::numeric_limits<double>::max(); // brute force
+            for (int f=0; f<m.nfacets(); f++)
+                dmin = std::min(dmin, (p - bvh.primitive(f).nearest_point(p)).norm());
+            CHECK( std::abs((p - static_cast<vec3>(bvh.nearest_point(p))).norm() - dmin) < 1e-12 );
+        }
+    };
+
+    for (vec3 &p : m.points) // bend the grid
+        p.z = .2*std::sin(3*p.x)*std::cos(2*p.y);
+    CHECK( !bvh.refit() );
+    check();
+
+    for (vec3 &p : m.points) // scramble the vertices
+        p = {rand()/(double)RAND_MAX, rand()/(double)RAND_MAX, rand()/(double)RAND_MAX};
+    CHECK( bvh.refit() );
+    check();
+}
+
+TEST_CASE("projection to polylines, quad and tetrahedral meshes", "[nearest]") {
+    auto rnd = []() { return vec3(rand()/(double)RAND_MAX*2-.5, rand()/(double)RAND_MAX*2-.5, rand()/(double)RAND_MAX*2-.5); };
+    std::vector<vec3> pts;
+    for (int i=0; i<500; i++) pts.push_back(rnd());
+
+    auto check = [&pts](const auto &bvh) { // compare to brute force
+        std::vector<PointOnMesh> nearest;
+        bvh.nearest_points(pts, nearest);
+        for (int i=0; i<(int)pts.size(); i++) {
+            double dmin = std::numeric_limits<double>::max();
+            for (int j=0; j<bvh.nprimitives(); j++)
+                dmin = std::min(dmin, (pts[i] - bvh.primitive(j).nearest_point(pts[i])).norm());
+            CHECK( std::abs((pts[i] - static_cast<vec3>(nearest[i])).norm() - dmin) < 1e-12 );
+            CHECK( std::abs((pts[i] - bvh.primitive(nearest[i].f).nearest_point(pts[i])).norm() - dmin) < 1e-12 );
+        }
+    };
+
+    PolyLine pl; // a helix
+    pl.points.create_points(201);
+    for (int v=0; v<=200; v++)
+        pl.points[v] = {.5+.4*std::cos(v*.1), .5+.4*std::sin(v*.1), v/200.};
+    for (int v=0; v<200; v++)
+        pl.edges.insert(pl.edges.end(), {v, v+1});
+    check(BVHSegments(pl));
+
+    Quads q; // a bumpy 10x10 grid
+    q.points.create_points(11*11);
+    for (int j=0; j<=10; j++)
+        for (int i=0; i<=10; i++)
+            q.points[i+j*11] = {i/10., j/10., .1*std::sin(i)*std::cos(j)};
+    for (int j=0; j<10; j++)
+        for (int i=0; i<10; i++)
+            q.facets.insert(q.facets.end(), {i+j*11, i+1+j*11, i+1+(j+1)*11, i+(j+1)*11});
+    check(BVHQuads(q));
+
+    Tetrahedra t; // unit cube, 3x3x3 subcubes split into 6 tetrahedra
+    const int n = 3;
+    auto id = [](int i, int j, int k) { return i + j*(n+1) + k*(n+1)*(n+1); };
+    t.points.create_points((n+1)*(n+1)*(n+1));
+    for (int k=0; k<=n; k++)
+        for (int j=0; j<=n; j++)
+            for (int i=0; i<=n; i++)
+                t.points[id(i, j, k)] = {i/double(n), j/double(n), k/double(n)};
+    for (int k=0; k<n; k++)
+        for (int j=0; j<n; j++)
+            for (int i=0; i<n; i++) {
+                int perm[3] = {0, 1, 2};
+                do { // walk from the corner (i,j,k) to (i+1,j+1,k+1) along the axes perm
+                    int c[3] = {i, j, k};
+                    t.cells.push_back(id(c[0], c[1], c[2]));
+                    for (int d : perm) {
+                        c[d]++;
+                        t.cells.push_back(id(c[0], c[1], c[2]));
+                    }
+                } while (std::next_permutation(perm, perm+3));
+            }
+    BVHTetrahedra bvh(t);
+    check(bvh);
+
+    std::vector<int> cells;
+    bvh.locate(pts, cells);
+    for (int i=0; i<(int)pts.size(); i++) {
+        bool inside = pts[i].x > 0 && pts[i].y > 0 && pts[i].z > 0 && pts[i].x < 1 && pts[i].y < 1 && pts[i].z < 1;
+        CHECK( (cells[i] >= 0) == inside );
+        if (inside) {
+            CHECK( bvh.primitive(cells[i]).contains(pts[i]) );
+            CHECK( (static_cast<vec3>(bvh.nearest_point(pts[i])) - pts[i]).norm() == 0 );
+        } else
+            CHECK( std::abs((static_cast<vec3>(bvh.nearest_point(pts[i])) - pts[i]).norm2() - dist2_box(bvh.tree[0], pts[i])) < 1e-12 );
+    }
+}
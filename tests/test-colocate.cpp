@@ -0,0 +1,47 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ultimaille/all.h>
+
+using namespace UM;
+
+static double rand01() {
+    return (rand()/(double)RAND_MAX);
+}
+
+TEST_CASE("Colocate clusters", "[colocate]") {
+    std::vector<vec3> centers, pts;
+    for (int i=0; i<2000; i++)
+        centers.push_back({rand01(), rand01(), rand01()*1e-2}); // thin slab: many neighboring cells are populated
+    for (int i=0; i<10000; i++) {
+        vec3 c = centers[rand()%centers.size()];
+        pts.push_back(c + vec3(rand01(), rand01(), rand01())*1e-7);
+    }
+    pts.push_back(pts[5]); // exact duplicate
+
+    std::vector<int> knn, grid;
+    colocate(pts, knn,  1e-6);
+    colocate(pts, grid, 1e-6, HASH_GRID);
+    CHECK( knn == grid );
+    for (int i=0; i<(int)pts.size(); i++) {
+        CHECK( grid[i] <= i );
+        CHECK( grid[grid[i]] == grid[i] );
+        CHECK( (pts[i]-pts[grid[i]]).norm() < 1e-6 );
+    }
+
+    colocate(pts, grid, 0., HASH_GRID);
+    CHECK( grid.back() == 5 );
+}
+
+TEST_CASE("Colocate a chain", "[colocate]") {
+    std::vector<vec3> pts = {{0,0,0}, {.9,0,0}, {1.8,0,0}, {2.7,0,0}, {10,0,0}};
+    std::vector<int> old2new;
+    colocate(pts, old2new, 1., HASH_GRID); // connected components of the "within tolerance" relation
+    CHECK( old2new == std::vector<int>{0, 0, 0, 0, 4} );
+}
+
+TEST_CASE("Colocate far and non-finite points", "[colocate]") {
+    const double inf = std::numeric_limits<double>::infinity(), nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<vec3> pts = {{1e300,0,0}, {1e300,0,0}, {-1e300,1,0}, {inf,0,0}, {nan,0,0}, {0,0,0}, {1e-12,0,0}};
+    std::vector<int> old2new;
+    colocate(pts, old2new, 1e-9, HASH_GRID); // |p/tolerance| is way beyond 2^63
+    CHECK( old2new == std::vector<int>{0, 0, 2, 3, 4, 5, 5} );
+}
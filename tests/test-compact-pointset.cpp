@@ -0,0 +1,162 @@
+#include <catch2/catch_test_macros.hpp>
+#include <fstream>
+#include <cstdint>
+#include <ultimaille/all.h>
+
+using namespace UM;
+
+static double rand01() {
+    return (rand()/(double)RAND_MAX);
+}
+
+TEST_CASE("Encoding precision", "[CompactPointSet]") {
+    PointSet pts;
+    for ([[maybe_unused]] int i : range(10000))
+        pts.push_back({100.*rand01(), -3.*rand01(), 7.+rand01()});
+
+    for (auto storage : {CompactPointSet::FLOAT32, CompactPointSet::QUANTIZED16}) {
+        CompactPointSet cps(pts, storage);
+        REQUIRE( cps.size()==pts.size() );
+        double eps = cps.precision();
+        for (int i : range(pts.size()))
+            CHECK( (pts[i]-cps[i]).norm() <= std::sqrt(3.)*eps*(1.+1e-6) );
+
+        BBox3 b1 = Meter<PointSet>(pts).bbox();
+        BBox3 b2 = Meter<CompactPointSet>(cps).bbox();
+        CHECK( (b1.min-b2.min).norm() <= 2.*eps );
+        CHECK( (b1.max-b2.max).norm() <= 2.*eps );
+
+        auto [axes1, eval1, center1] = Meter<PointSet>(pts).principal_axes();
+        auto [axes2, eval2, center2] = Meter<CompactPointSet>(cps).principal_axes();
+        CHECK( (center1-center2).norm() < 1e-2 );
+        CHECK( (eval1-eval2).norm() < 1e-2 );
+    }
+}
+
+TEST_CASE("k-NN over compact storage", "[CompactPointSet]") {
+    PointSet pts;
+    for ([[maybe_unused]] int i : range(1000))
+        pts.push_back({rand01(), rand01(), rand01()});
+    CompactPointSet cps(pts, CompactPointSet::FLOAT32);
+
+    PointSet decoded;
+    cps.decode(decoded);
+    KNN<3> knn1(*decoded.data);
+    KNN<3, CompactPointSet> knn2(cps);
+    for (int i : range(100)) {
+        vec3 q = {rand01(), rand01(), rand01()};
+        CHECK( knn1.query(q, 5) == knn2.query(q, 5) );
+        CHECK( knn2.query(cps[i])[0] == i );
+    }
+}
+
+TEST_CASE("Compact point set IO", "[CompactPointSet]") {
+    PointSet pts;
+    for ([[maybe_unused]] int i : range(100))
+        pts.push_back({rand01(), rand01(), rand01()});
+
+    for (auto storage : {CompactPointSet::FLOAT32, CompactPointSet::QUANTIZED16}) {
+        CompactPointSet cps(pts, storage);
+        for (std::string filename : {"ultimaille-test-compact.xyz", "ultimaille-test-compact.geogram"}) {
+            CompactPointSet res(storage, cps.frame);
+            if (filename.ends_with(".xyz")) {
+                write_xyz(filename, cps);
+                read_xyz(filename, res);
+            } else {
+                write_geogram(filename, cps);
+                read_geogram(filename, res);
+            }
+            REQUIRE( res.size()==cps.size() );
+            for (int i : range(cps.size()))
+                CHECK( (res[i]-cps[i]).norm() < 1e-6 );
+
+            PointSet full; // single precision files are readable as regular point sets
+            read_by_extension(filename, full);
+            REQUIRE( full.size()==cps.size() );
+            for (int i : range(cps.size()))
+                CHECK( (full[i]-cps[i]).norm() < 1e-6 );
+        }
+    }
+}
+
+TEST_CASE("Compact point set bit-exact IO", "[CompactPointSet]") {
+    PointSet pts; // far from the origin: the decoded coordinates need more than the 24 bits of a float
+    for ([[maybe_unused]] int i : range(1000))
+        pts.push_back(vec3(1e7, -3e7, 5e6) + vec3(rand01(), rand01(), rand01())*1e3);
+    CompactPointSet cps(pts, CompactPointSet::QUANTIZED16);
+
+    for (BBox3 frame : {BBox3(), cps.frame}) { // the frame is read from the file, or given
+        CompactPointSet res(CompactPointSet::QUANTIZED16, frame);
+        write_geogram("ultimaille-test-compact.geogram", cps);
+        read_geogram("ultimaille-test-compact.geogram", res);
+        CHECK( (res.frame.min-cps.frame.min).norm2()==0 );
+        CHECK( (res.frame.max-cps.frame.max).norm2()==0 );
+        CHECK( res.q16==cps.q16 );
+    }
+
+    CompactPointSet res(CompactPointSet::QUANTIZED16, cps.frame);
+    write_xyz("ultimaille-test-compact.xyz", cps);
+    read_xyz("ultimaille-test-compact.xyz", res);
+    CHECK( res.q16==cps.q16 );
+
+    PointSet full;
+    read_geogram("ultimaille-test-compact.geogram", full);
+    REQUIRE( full.size()==cps.size() );
+    for (int i : range(cps.size()))
+        CHECK( (full[i]-cps[i]).norm2()==0 );
+
+    CompactPointSet f32(CompactPointSet::FLOAT32); // double precision files are converted by chunks
+    write_geogram("ultimaille-test-compact.geogram", pts);
+    read_geogram("ultimaille-test-compact.geogram", f32);
+    REQUIRE( f32.size()==pts.size() );
+    CompactPointSet q16(CompactPointSet::QUANTIZED16);
+    read_geogram("ultimaille-test-compact.geogram", q16);
+    CHECK( q16.q16==cps.q16 ); // quantized from the doubles, not from a float intermediate
+}
+
+TEST_CASE("Foreign uint16 attributes", "[CompactPointSet]") { // only the "point_q16" vertices come with a quantization frame
+    std::vector<vec3> pts = {{0, 0, 0}, {1, 2, 3}, {-1, .5, 4}};
+    std::vector<std::uint16_t> q16 = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    auto write = [&](const std::string &path, bool frame, const std::string &name) { // geogram chunks, uncompressed
+        std::ofstream out(path, std::ios::binary);
+        auto u32 = [&out](std::uint32_t v) { out.write(reinterpret_cast<const char *>(&v), 4); };
+        auto u64 = [&out](std::uint64_t v) { out.write(reinterpret_cast<const char *>(&v), 8); };
+        auto str = [&](const std::string &t) { u32(t.size()); out.write(t.data(), t.size()); };
+        auto attr = [&](const std::string &set, const std::string &name, const std::string &type, const void *data, int size, int dim, int n) {
+            out.write("ATTR", 4);
+            u64(4+set.size() + 4+name.size() + 4+type.size() + 8 + size_t(size)*dim*n);
+            str(set); str(name); str(type); u32(size); u32(dim);
+            out.write(static_cast<const char *>(data), size_t(size)*dim*n);
+        };
+        out.write("HEAD", 4); u64(4+7+4+3); str("GEOGRAM"); str("1.0");
+        if (frame) {
+            const vec3 box[2] = {{-1, -1, -1}, {1, 1, 1}};
+            out.write("ATTS", 4); u64(4+26+4); str("UM::CompactPointSet::frame"); u32(2);
+            attr("UM::CompactPointSet::frame", "frame", "double", box, 8, 3, 2);
+        }
+        out.write("ATTS", 4); u64(4+19+4); str("GEO::Mesh::vertices"); u32(3);
+        attr("GEO::Mesh::vertices", "point", "double", pts.data(), 8, 3, 3);
+        attr("GEO::Mesh::vertices", name, "uint16", q16.data(), 2, 3, 3);
+    };
+
+    for (bool frame : {false, true}) {
+        write("ultimaille-test-compact.geogram", frame, "color");
+        PointSet m;
+        PointSetAttributes attr = read_geogram("ultimaille-test-compact.geogram", m);
+        REQUIRE( m.size()==3 );
+        for (int v : range(3))
+            CHECK( (m[v]-pts[v]).norm2()==0 );
+        for (auto &a : attr.points)
+            CHECK( a.first!="color" );
+    }
+
+    write("ultimaille-test-compact.geogram", false, "point_q16"); // no frame: the quantized coordinates cannot be decoded
+    PointSet m;
+    PointSetAttributes attr = read_geogram("ultimaille-test-compact.geogram", m);
+    REQUIRE( m.size()==3 );
+    for (int v : range(3))
+        CHECK( (m[v]-pts[v]).norm2()==0 );
+    for (auto &a : attr.points)
+        CHECK( a.first!="point_q16" );
+}
+
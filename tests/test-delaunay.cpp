@@ -0,0 +1,173 @@
+#include <catch2/catch_test_macros.hpp>
+#include <random>
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+#include <ultimaille/all.h>
+
+using namespace UM;
+
+TEST_CASE("predicates", "[delaunay]") {
+    CHECK( orient2d({0, 0}, {1, 0}, {0, 1}) == 1 );
+    CHECK( orient2d({0, 0}, {0, 1}, {1, 0}) == -1 );
+    CHECK( orient3d({0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}) == 1 );
+    CHECK( orient3d({0, 0, 0}, {0, 1, 0}, {1, 0, 0}, {0, 0, 1}) == -1 );
+    CHECK( incircle({0, 0}, {1, 0}, {0, 1}, {.5, .5}) == 1 );
+    CHECK( incircle({0, 0}, {1, 0}, {0, 1}, {1, 1}) == 0 );
+    CHECK( incircle({0, 0}, {1, 0}, {0, 1}, {2, 2}) == -1 );
+    CHECK( insphere({0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {.2, .2, .2}) == 1 );
+    CHECK( insphere({0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 1, 1}) == 0 );
+    CHECK( insphere({0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {2, 2, 2}) == -1 );
+
+    // near-degenerate configurations where the floating point evaluation is unreliable:
+    // orient2d(p, (12,12), (24,24)) = 12*(p.y - p.x)
+    const double ulp = std::ldexp(1., -53);
+    for (int i=0; i<64; i++)
+        for (int j=0; j<64; j++) {
+            vec2 p = {.5 + i*ulp, .5 + j*ulp};
+            CHECK( orient2d(p, {12, 12}, {24, 24}) == (j>i) - (j<i) );
+            CHECK( orient3d(p.xy0(), {12, 12, 0}, {24, 24, 0}, {0, 0, 1}) == orient2d(p, {12, 12}, {24, 24}) );
+        }
+
+    std::mt19937 gen(0); // points on the unit sphere with exact coordinates: Pythagorean triples
+    const int triples[][3] = {{3, 4, 0}, {0, 3, 4}, {4, 0, 3}, {-3, 4, 0}, {0, -4, 3}, {-4, 0, -3}, {3, -4, 0}};
+    std::vector<vec3> sphere;
+    for (auto &t : triples) sphere.push_back(vec3(t[0], t[1], t[2])/5.);
+    for (int iter=0; iter<100; iter++) {
+        std::shuffle(sphere.begin(), sphere.end(), gen);
+        vec3 a = sphere[0], b = sphere[1], c = sphere[2], d = sphere[3];
+        int o = orient3d(a, b, c, d);
+        if (!o) continue;
+        if (o < 0) std::swap(a, b);
+        CHECK( insphere(a, b, c, d, sphere[4]) == 0 );
+        CHECK( insphere(a, b, c, d, sphere[4]*(1-ulp)) == 1 );
+        CHECK( insphere(a, b, c, d, sphere[4]*(1+2*ulp)) == -1 );
+    }
+}
+
+static double area(const Triangles &m) {
+    double sum = 0;
+    for (int f=0; f<m.nfacets(); f++) {
+        vec3 a = m.points[m.vert(f, 0)], b = m.points[m.vert(f, 1)], c = m.points[m.vert(f, 2)];
+        sum += cross(b-a, c-a).z/2.;
+    }
+    return sum;
+}
+
+static void check_delaunay2d(const std::vector<vec2> &pts, const Triangles &m) {
+    for (int f=0; f<m.nfacets(); f++) {
+        vec2 a = pts[m.vert(f, 0)], b = pts[m.vert(f, 1)], c = pts[m.vert(f, 2)];
+        REQUIRE( orient2d(a, b, c) > 0 );
+        for (const vec2 &p : pts)
+            CHECK( incircle(a, b, c, p) <= 0 );
+    }
+}
+
+static void check_delaunay3d(const std::vector<vec3> &pts, const Tetrahedra &m) {
+    for (int c=0; c<m.ncells(); c++) {
+        vec3 a = pts[m.vert(c, 0)], b = pts[m.vert(c, 1)], d = pts[m.vert(c, 2)], e = pts[m.vert(c, 3)];
+        REQUIRE( orient3d(a, b, d, e) > 0 );
+        for (const vec3 &p : pts)
+            CHECK( insphere(a, b, d, e, p) <= 0 );
+    }
+}
+
+TEST_CASE("delaunay 2d", "[delaunay]") {
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> rnd(0, 1);
+    std::vector<vec2> pts = {{0, 0}, {1, 0}, {1, 1}, {0, 1}}; // the convex hull is the unit square
+    for (int i=0; i<2000; i++) pts.push_back({rnd(gen), rnd(gen)});
+    pts.push_back(pts[10]); // duplicate
+    Triangles m;
+    delaunay2d(pts, m);
+    CHECK( m.nverts() == static_cast<int>(pts.size()) );
+    CHECK( m.nfacets() == 2*(static_cast<int>(pts.size())-1) - 2 - 4 ); // Euler: 2n-2-h triangles
+    CHECK( std::abs(area(m) - 1.) < 1e-12 );
+    check_delaunay2d(pts, m);
+
+    std::vector<vec2> grid; // cocircular points everywhere
+    for (int j=0; j<20; j++)
+        for (int i=0; i<20; i++)
+            grid.push_back({double(i), double(j)});
+    delaunay2d(grid, m);
+    CHECK( m.nfacets() == 2*19*19 );
+    CHECK( std::abs(area(m) - 19.*19.) < 1e-9 );
+    check_delaunay2d(grid, m);
+
+    delaunay2d({{0, 0}, {1, 1}, {2, 2}, {3, 3}}, m); // collinear
+    CHECK( m.nfacets() == 0 );
+}
+
+TEST_CASE("delaunay 3d", "[delaunay]") {
+    std::mt19937 gen(2);
+    std::uniform_real_distribution<double> rnd(0, 1);
+    std::vector<vec3> pts;
+    for (int i=0; i<8; i++) // the convex hull is the unit cube
+        pts.push_back({double(i&1), double((i>>1)&1), double((i>>2)&1)});
+    for (int i=0; i<1000; i++) pts.push_back({rnd(gen), rnd(gen), rnd(gen)});
+    pts.push_back(pts[20]);
+    Tetrahedra m;
+    delaunay3d(pts, m);
+    CHECK( m.nverts() == static_cast<int>(pts.size()) );
+    double volume = 0;
+    for (auto c : m.iter_cells()) volume += Tetrahedron(c).volume();
+    CHECK( std::abs(volume - 1.) < 1e-12 );
+    check_delaunay3d(pts, m);
+
+    std::vector<vec3> grid; // cospherical points everywhere
+    for (int k=0; k<6; k++)
+        for (int j=0; j<6; j++)
+            for (int i=0; i<6; i++)
+                grid.push_back({double(i), double(j), double(k)});
+    delaunay3d(grid, m);
+    volume = 0;
+    for (auto c : m.iter_cells()) {
+        CHECK( Tetrahedron(c).volume() > 0 ); // no flat tetrahedron
+        volume += Tetrahedron(c).volume();
+    }
+    CHECK( std::abs(volume - 125.) < 1e-9 );
+    check_delaunay3d(grid, m);
+
+    delaunay3d({{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {1, 1, 0}, {2, 3, 0}}, m); // coplanar
+    CHECK( m.ncells() == 0 );
+}
+
+TEST_CASE("parallel delaunay", "[delaunay]") {
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<double> rnd(0, 1);
+    std::vector<vec3> pts; // random points: no cospherical subset, the Delaunay triangulation is unique whatever the insertion order
+    for (int i=0; i<50000; i++) pts.push_back({rnd(gen), rnd(gen), rnd(gen)});
+    std::vector<vec2> pts2d;
+    for (int i=0; i<100000; i++) pts2d.push_back({rnd(gen), rnd(gen)});
+
+    auto sorted_simplices = [](const std::vector<int> &vert, const int N) { // orientation aside
+        std::vector<std::vector<int> > simplices;
+        for (int s=0; s<static_cast<int>(vert.size())/N; s++) {
+            simplices.emplace_back(vert.begin() + s*N, vert.begin() + (s+1)*N);
+            std::sort(simplices.back().begin(), simplices.back().end());
+        }
+        std::sort(simplices.begin(), simplices.end());
+        return simplices;
+    };
+
+    Tetrahedra parallel, sequential;
+    Triangles parallel2d, sequential2d;
+    delaunay3d(pts, parallel);
+    delaunay2d(pts2d, parallel2d);
+#if defined(_OPENMP)
+    const int nthreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+#endif
+    delaunay3d(pts, sequential);
+    delaunay2d(pts2d, sequential2d);
+#if defined(_OPENMP)
+    omp_set_num_threads(nthreads);
+#endif
+
+    for (auto c : parallel.iter_cells())
+        REQUIRE( Tetrahedron(c).volume() > 0 );
+    bool same = sorted_simplices(parallel.cells, 4) == sorted_simplices(sequential.cells, 4);
+    CHECK( same );
+    same = sorted_simplices(parallel2d.facets, 3) == sorted_simplices(sequential2d.facets, 3);
+    CHECK( same );
+}
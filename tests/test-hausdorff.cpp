@@ -0,0 +1,45 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ultimaille/all.h>
+
+using namespace UM;
+
+static void grid(Triangles &m, const int n, const double z) { // n x n unit square at height z
+    m.points.create_points((n+1)*(n+1));
+    for (int j=0; j<=n; j++)
+        for (int i=0; i<=n; i++)
+            m.points[i+j*(n+1)] = {i/double(n), j/double(n), z};
+    for (int j=0; j<n; j++)
+        for (int i=0; i<n; i++) {
+            int v = i+j*(n+1);
+            m.facets.insert(m.facets.end(), {v, v+1, v+n+2, v, v+n+2, v+n+1});
+        }
+}
+
+TEST_CASE("Hausdorff distance", "[hausdorff]") {
+    Triangles a, b;
+    grid(a, 10, 0);
+    grid(b, 7, .1);
+
+    SurfaceDistance d = hausdorff_distance(a, b, 10000);
+    CHECK( std::abs(d.max  - .1) < 1e-12 );
+    CHECK( std::abs(d.mean - .1) < 1e-12 );
+    CHECK( std::abs(d.rms  - .1) < 1e-12 );
+
+    b.points[4*8+4].z = .6; // a bump on b
+    PointAttribute<double> dist(b);
+    SurfaceDistance ba = one_sided_distance(b, a, 10000, &dist);
+    CHECK( std::abs(ba.max - .6) < 1e-12 );
+    CHECK( ba.mean > .1 );
+    CHECK( ba.rms > ba.mean );
+    for (int v : range(b.nverts()))
+        CHECK( std::abs(dist[v] - b.points[v].z) < 1e-12 );
+
+    SurfaceDistance ab = one_sided_distance(a, b, 10000);
+    CHECK( ab.max < ba.max ); // the bump is far from a, but a is close to b
+
+    SurfaceDistance exact = hausdorff_distance(a, b, 10000);
+    SurfaceDistance fast  = hausdorff_distance(a, b, 10000, nullptr, nullptr, true);
+    CHECK( std::abs(exact.max - .6) < 1e-12 );
+    CHECK( fast.max == exact.max );
+    CHECK( fast.mean == 0 );
+}
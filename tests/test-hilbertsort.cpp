@@ -31,3 +31,29 @@ TEST_CASE("Test max dist", "[Hilbert sort]") {
     CHECK( 1./std::cbrt(n) * 7 > maxdist ); // n^(1/3) samples per cube edge, ideally n^(-1/3) max dist, take 7 times that to be sure
 }
 
+
+TEST_CASE("Test BRIO", "[Hilbert sort]") {
+    int n = 100000;
+    std::vector<vec3> pts(n);
+    for (vec3 &p : pts)
+        p = {rand01(), rand01(), rand01()};
+
+    Permutation perm(n);
+    HilbertSort(pts).brio(perm.ind);
+
+    std::vector<int> sorted = perm.ind; // it is a permutation
+    std::sort(sorted.begin(), sorted.end());
+    for (int i=0; i<n; i++)
+        CHECK( sorted[i]==i );
+
+    auto mean_dist = [&](int begin, int end) {
+        double sum = 0;
+        for (int i=begin; i+1<end; i++)
+            sum += (pts[perm.ind[i]] - pts[perm.ind[i+1]]).norm();
+        return sum / (end-begin-1);
+    };
+    // the last round holds half of the points, it is Hilbert sorted: consecutive points are close
+    CHECK( mean_dist(n/2, n) < 3./std::cbrt(n/2) );
+    // the rounds are random: the first points are spread over the whole cube
+    CHECK( mean_dist(0, 64) > .2 );
+}
@@ -61,6 +61,233 @@ TEST_CASE("query many", "[k-NN]") {
     }
 }
 
+TEST_CASE("query batch", "[k-NN]") {
+    std::vector<vec3> pts, queries;
+    for (int i=0; i<2000; i++)
+        pts.push_back({rand()/(double)RAND_MAX, rand()/(double)RAND_MAX, rand()/(double)RAND_MAX});
+    for (int i=0; i<500; i++)
+        queries.push_back({rand()/(double)RAND_MAX, rand()/(double)RAND_MAX, rand()/(double)RAND_MAX});
+    KNN<3> knn(pts);
+
+    for (bool hilbert : {false, true}) {
+        std::vector<int> neigh;
+        std::vector<double> dist2;
+        knn.query_batch(queries, 7, neigh, &dist2, hilbert);
+        REQUIRE( neigh.size()==queries.size()*7 );
+        for (int q=0; q<(int)queries.size(); q++) {
+            std::vector<int> ref = knn.query(queries[q], 7);
+            for (int j=0; j<7; j++) {
+                CHECK( neigh[q*7+j] == ref[j] );
+                CHECK( dist2[q*7+j] == (queries[q]-pts[ref[j]]).norm2() );
+            }
+        }
+    }
+
+    std::vector<int> neigh;
+    knn.query_batch({{0,0,0}}, 3000, neigh);
+    CHECK( neigh.size()==pts.size() ); // k is clamped to the number of points
+}
+
+TEST_CASE("radius query", "[k-NN]") {
+    std::vector<vec2> pts, queries;
+    for (int i=0; i<2000; i++)
+        pts.push_back({rand()/(double)RAND_MAX, rand()/(double)RAND_MAX});
+    for (int i=0; i<3000; i++)
+        queries.push_back({rand()/(double)RAND_MAX, rand()/(double)RAND_MAX});
+    KNN<2> knn(pts);
+    const double r = .05;
+
+    std::vector<int> offset, neighbors;
+    knn.radius_query_batch(queries, r, offset, neighbors);
+    REQUIRE( offset.size()==queries.size()+1 );
+    REQUIRE( offset.back()==(int)neighbors.size() );
+    for (int q=0; q<(int)queries.size(); q++) {
+        std::vector<int> ref;
+        for (int i=0; i<(int)pts.size(); i++)
+            if ((queries[q]-pts[i]).norm() <= r) ref.push_back(i);
+        std::vector<int> res = knn.radius_query(queries[q], r);
+        std::vector<int> batch(neighbors.begin()+offset[q], neighbors.begin()+offset[q+1]);
+        std::sort(res.begin(), res.end());
+        std::sort(batch.begin(), batch.end());
+        CHECK( res == ref );
+        CHECK( batch == ref );
+    }
+}
+
+TEST_CASE("bucketed tree", "[k-NN]") {
+    std::vector<vec3> pts, queries;
+    for (int i=0; i<5000; i++)
+        pts.push_back({rand()/(double)RAND_MAX, rand()/(double)RAND_MAX, rand()/(double)RAND_MAX});
+    for (int i=0; i<200; i++)
+        queries.push_back({rand()/(double)RAND_MAX, rand()/(double)RAND_MAX, rand()/(double)RAND_MAX});
+    KNN<3> knn(pts);
+
+    for (int leaf_size : {8, 16, 32}) {
+        KNN<3> bucketed(pts, leaf_size);
+        for (const vec3 &q : queries) {
+            CHECK( bucketed.query(q, 10) == knn.query(q, 10) );
+            std::vector<int> res = bucketed.radius_query(q, .1), ref = knn.radius_query(q, .1);
+            std::sort(res.begin(), res.end());
+            std::sort(ref.begin(), ref.end());
+            CHECK( res == ref );
+        }
+    }
+}
+
+TEST_CASE("approximate query", "[k-NN]") {
+    std::vector<vec3> pts;
+    for (int i=0; i<20000; i++)
+        pts.push_back({rand()/(double)RAND_MAX, rand()/(double)RAND_MAX, rand()/(double)RAND_MAX});
+    for (int leaf_size : {1, 16}) {
+        KNN<3> knn(pts, leaf_size);
+        for (int iter=0; iter<200; iter++) {
+            vec3 q = {rand()/(double)RAND_MAX, rand()/(double)RAND_MAX, rand()/(double)RAND_MAX};
+            std::vector<int> exact = knn.query(q, 5);
+            CHECK( knn.query_approx(q, 5, 0.) == exact );
+            std::vector<int> approx = knn.query_approx(q, 5, .5);
+            REQUIRE( approx.size()==5 );
+            for (int j=0; j<5; j++)
+                CHECK( (q-pts[approx[j]]).norm() <= 1.5*(q-pts[exact[j]]).norm() + 1e-12 );
+            CHECK( knn.query_approx(q, 5, 0., 1).size()==5 ); // a single leaf still returns a full neighborhood
+        }
+
+        // k > max_leaves*leaf_size: the budget only applies once the neighborhood is full
+        std::vector<vec3> queries(100);
+        for (vec3 &q : queries) q = {rand()/(double)RAND_MAX, rand()/(double)RAND_MAX, rand()/(double)RAND_MAX};
+        std::vector<int> out;
+        std::vector<double> dist2;
+        knn.query_batch(queries, 64, out, &dist2, false, 0., 1);
+        REQUIRE( out.size()==queries.size()*64 );
+        for (int q=0; q<static_cast<int>(queries.size()); q++) {
+            std::vector<int> nbrs(out.begin()+q*64, out.begin()+(q+1)*64);
+            CHECK( nbrs == knn.query_approx(queries[q], 64, 0., 1) );
+            std::sort(nbrs.begin(), nbrs.end());
+            CHECK( std::unique(nbrs.begin(), nbrs.end()) == nbrs.end() );
+            for (int j=0; j<64; j++) {
+                REQUIRE( out[q*64+j]>=0 );
+                REQUIRE( out[q*64+j]<static_cast<int>(pts.size()) );
+                CHECK( std::abs(dist2[q*64+j] - (queries[q]-pts[out[q*64+j]]).norm2()) < 1e-12 );
+                if (j) CHECK( dist2[q*64+j-1] <= dist2[q*64+j] );
+            }
+        }
+    }
+}
+
+TEST_CASE("dynamic insertion and deletion", "[k-NN]") {
+    auto rnd = []() { return vec2(rand()/(double)RAND_MAX, rand()/(double)RAND_MAX); };
+    DynamicKNN<2> dknn;
+    std::vector<vec2> pts;
+    std::vector<bool> alive;
+    for (int iter=0; iter<3000; iter++) {
+        if (rand()%3 || !dknn.size()) {
+            vec2 p = rnd();
+            int id = dknn.insert(p);
+            REQUIRE( id>=0 );
+            if (id >= (int)pts.size()) {
+                pts.resize(id+1);
+                alive.resize(id+1, false);
+            }
+            CHECK( !alive[id] ); // the id of an erased point may be reused
+            pts[id] = p;
+            alive[id] = true;
+        } else {
+            int id = dknn.query(rnd())[0];
+            dknn.erase(id);
+            alive[id] = false;
+        }
+        if (iter%100) continue;
+
+        vec2 q = rnd();
+        std::vector<std::pair<double, int> > ref;
+        for (int i=0; i<(int)pts.size(); i++)
+            if (alive[i]) ref.emplace_back((q-pts[i]).norm2(), i);
+        std::sort(ref.begin(), ref.end());
+        REQUIRE( dknn.size()==(int)ref.size() );
+        std::vector<int> neigh = dknn.query(q, 5);
+        REQUIRE( neigh.size()==std::min<size_t>(5, ref.size()) );
+        for (int j=0; j<(int)neigh.size(); j++)
+            CHECK( neigh[j]==ref[j].second );
+
+        std::vector<int> res = dknn.radius_query(q, .1), exp;
+        for (auto [d2, i] : ref)
+            if (d2 <= .01) exp.push_back(i);
+        std::sort(res.begin(), res.end());
+        std::sort(exp.begin(), exp.end());
+        CHECK( res==exp );
+    }
+
+    // constant number of alive points: the memory does not grow with the number of insertions
+    for (int iter=0; iter<100000; iter++) {
+        dknn.erase(dknn.query(rnd())[0]);
+        dknn.insert(rnd());
+    }
+    CHECK( dknn.points.size() <= 4*static_cast<size_t>(dknn.size()) + 1 );
+}
+
+TEST_CASE("hash grid", "[k-NN]") {
+    auto rnd = []() { return vec3(rand()/(double)RAND_MAX, rand()/(double)RAND_MAX, rand()/(double)RAND_MAX); };
+    auto check = [&rnd](const auto &grid, const auto &pts) {
+        for (int iter=0; iter<50; iter++) {
+            vec3 q = rnd()*1.4 - vec3(.2, .2, .2);
+            std::vector<std::pair<double, int> > ref;
+            for (int i=0; i<(int)pts.size(); i++)
+                ref.emplace_back((q-pts[i]).norm2(), i);
+            std::sort(ref.begin(), ref.end());
+            std::vector<int> neigh = grid.query(q, 7);
+            REQUIRE( neigh.size()==7 );
+            for (int j=0; j<7; j++)
+                CHECK( neigh[j]==ref[j].second );
+
+            std::vector<int> res = grid.radius_query(q, .15), exp;
+            for (auto [d2, i] : ref)
+                if (d2 <= .15*.15) exp.push_back(i);
+            std::sort(res.begin(), res.end());
+            std::sort(exp.begin(), exp.end());
+            CHECK( res==exp );
+
+            BBox3 box(q, q + rnd()*.3);
+            res = grid.box_query(box);
+            exp.clear();
+            for (int i=0; i<(int)pts.size(); i++)
+                if (box.contains(pts[i])) exp.push_back(i);
+            std::sort(res.begin(), res.end());
+            CHECK( res==exp );
+        }
+    };
+
+    std::vector<vec3> pts(5000); // uniform in the unit cube
+    for (vec3 &p : pts) p = rnd();
+    check(HashGrid<3>(pts), pts);
+    check(HashGrid<3>(pts, .05), pts);
+
+    PointSet sphere; // a surface: the cell size is adapted to the actual occupancy
+    sphere.create_points(5000);
+    for (vec3 &p : sphere) p = vec3(.5, .5, .5) + (rnd() - vec3(.5, .5, .5)).normalized()*.5;
+    HashGrid<3, PointSet> grid(sphere, 0, 4.);
+    CHECK( grid.h < .1 );
+    check(grid, sphere);
+
+    // the rings around a cell partition the grid, each cell is visited once
+    std::array<int, 3> c = {2, grid.ncells[1]-1, grid.ncells[2]/2};
+    std::vector<int> visits(grid.ncells[0]*grid.ncells[1]*grid.ncells[2], 0);
+    for (int r=0; r<std::max({grid.ncells[0], grid.ncells[1], grid.ncells[2]}); r++)
+        grid.for_each_ring_cell(c, r, [&](const std::array<int, 3> &cc) {
+            CHECK( std::max({std::abs(cc[0]-c[0]), std::abs(cc[1]-c[1]), std::abs(cc[2]-c[2])}) == r );
+            visits[grid.key(cc)]++;
+        });
+    CHECK( std::count(visits.begin(), visits.end(), 1) == static_cast<int>(visits.size()) );
+
+    vec3 far = {5, -3, .5}; // far from the bounding box
+    std::vector<std::pair<double, int> > ref;
+    for (int i=0; i<sphere.size(); i++)
+        ref.emplace_back((far-sphere[i]).norm2(), i);
+    std::sort(ref.begin(), ref.end());
+    std::vector<int> neigh = grid.query(far, 3);
+    REQUIRE( neigh.size()==3 );
+    for (int j=0; j<3; j++)
+        CHECK( neigh[j]==ref[j].second );
+}
+
 TEST_CASE("query .geogram", "[k-NN]") {
     PointSet cloud, request;
     read_geogram(std::string(TEST_INPUT_DIR) +   "knn-cloud.geogram", cloud);
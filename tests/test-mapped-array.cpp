@@ -0,0 +1,146 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ultimaille/all.h>
+
+using namespace UM;
+
+static double rand01() {
+    return (rand()/(double)RAND_MAX);
+}
+
+TEST_CASE("Mapped point coordinates", "[MappedArray]") {
+    PointSet pts;
+    for ([[maybe_unused]] int i : range(1000))
+        pts.push_back({rand01(), rand01(), rand01()});
+    write_mapped_array("ultimaille-test-mapped.bin", *pts.data);
+
+    MappedArray<vec3> mapped("ultimaille-test-mapped.bin", MappedFile::RANDOM);
+    REQUIRE( mapped.size()==pts.size() );
+    for (int i : range(pts.size()))
+        CHECK( (mapped[i]-pts[i]).norm2()==0 );
+
+    BBox3 b1 = Meter<PointSet>(pts).bbox();
+    BBox3 b2 = Meter<MappedArray<vec3> >(mapped).bbox();
+    CHECK( (b1.min-b2.min).norm2()==0 );
+    CHECK( (b1.max-b2.max).norm2()==0 );
+    CHECK( (Meter<PointSet>(pts).barycenter()-Meter<MappedArray<vec3> >(mapped).barycenter()).norm() < 1e-10 );
+
+    KNN<3> knn1(*pts.data);
+    KNN<3, MappedArray<vec3> > knn2(mapped);
+    for ([[maybe_unused]] int i : range(100)) {
+        vec3 q = {rand01(), rand01(), rand01()};
+        CHECK( knn1.query(q, 5) == knn2.query(q, 5) );
+    }
+}
+
+TEST_CASE("Mapped connectivity", "[MappedArray]") {
+    Triangles m;
+    m.points.create_points(4);
+    m.create_facets(2);
+    for (int lv : range(3)) {
+        m.vert(0, lv) = lv;
+        m.vert(1, lv) = lv+1;
+    }
+    write_mapped_array("ultimaille-test-mapped.bin", m.facets);
+
+    MappedArray<int> facets("ultimaille-test-mapped.bin");
+    REQUIRE( facets.size()==6 );
+    CHECK( std::equal(facets.begin(), facets.end(), m.facets.begin()) );
+
+    write_mapped_array("ultimaille-test-mapped.bin", std::vector<int>());
+    CHECK( MappedArray<int>("ultimaille-test-mapped.bin").size()==0 );
+}
+
+TEST_CASE("Mapped facet and cell kernels", "[MappedArray]") {
+    Tetrahedra m;
+    for ([[maybe_unused]] int i : range(200))
+        m.points.push_back({rand01(), rand01(), rand01()});
+    m.create_cells(300);
+    for (int c : range(m.ncells()))
+        for (int lv : range(4))
+            m.vert(c, lv) = rand()%m.nverts();
+    write_mapped_array("ultimaille-test-mapped.bin", *m.points.data);
+    write_mapped_array("ultimaille-test-mapped-cells.bin", m.cells);
+    MappedArray<vec3> pts("ultimaille-test-mapped.bin");
+    MappedArray<int> cells("ultimaille-test-mapped-cells.bin", MappedFile::SEQUENTIAL);
+    MappedArray<int> triangles("ultimaille-test-mapped-cells.bin"); // the first 3*(4*300/3) corners read as triangles
+    Meter<MappedArray<vec3> > meter(pts);
+
+    std::vector<double> volumes = meter.cell_volumes(cells);
+    REQUIRE( static_cast<int>(volumes.size())==m.ncells() );
+    double total = 0;
+    for (auto c : m.iter_cells()) {
+        CHECK( volumes[c] == Tetrahedron(c).volume() );
+        total += volumes[c];
+    }
+    CHECK( std::abs(meter.volume(cells) - total) < 1e-12 );
+
+    std::vector<double> areas = meter.facet_areas(triangles);
+    std::vector<vec3> normals = meter.facet_normals(triangles);
+    REQUIRE( areas.size()==400 );
+    REQUIRE( normals.size()==400 );
+    total = 0;
+    for (int f : range(400)) {
+        Triangle3 t(m.points[m.cells[3*f]], m.points[m.cells[3*f+1]], m.points[m.cells[3*f+2]]);
+        CHECK( areas[f] == t.unsigned_area() );
+        if (areas[f] > 0) CHECK( (normals[f] - t.normal()).norm2() == 0 ); // N.B. random corners may repeat
+        total += areas[f];
+    }
+    CHECK( std::abs(meter.area(triangles) - total) < 1e-12 );
+}
+
+TEST_CASE("Mapped boundary extraction", "[MappedArray]") {
+    const int n = 4; // Kuhn subdivision of a n^3 grid: 6 tetrahedra per cube
+    auto id = [n](int i, int j, int k) { return i + (n+1)*(j + (n+1)*k); };
+    Tetrahedra m;
+    for (int k : range(n+1)) for (int j : range(n+1)) for (int i : range(n+1))
+        m.points.push_back(vec3(i, j, k)/n);
+    const int perm[6][3] = {{0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0}};
+    for (int k : range(n)) for (int j : range(n)) for (int i : range(n))
+        for (auto &p : perm) {
+            int off = m.create_cells(1);
+            int c[3] = {i, j, k};
+            m.vert(off, 0) = id(c[0], c[1], c[2]);
+            for (int lv : range(3)) {
+                c[p[lv]]++;
+                m.vert(off, lv+1) = id(c[0], c[1], c[2]);
+            }
+            if (Tetrahedron(Volume::Cell(m, off)).volume() < 0) // half-facets are matched by opposite orientations
+                std::swap(m.vert(off, 2), m.vert(off, 3));
+        }
+    m.connect();
+    std::vector<int> expected;
+    for (auto f : m.iter_facets())
+        if (f.on_boundary())
+            for (int lv : range(3))
+                expected.push_back(f.vertex(lv));
+    CHECK( expected.size()==3*2*6*n*n );
+
+    write_mapped_array("ultimaille-test-mapped.bin", *m.points.data);
+    write_mapped_array("ultimaille-test-mapped-cells.bin", m.cells);
+    MappedArray<vec3> pts("ultimaille-test-mapped.bin");
+    Meter<MappedArray<vec3> > meter(pts);
+    CHECK( meter.boundary_facets(MappedArray<int>("ultimaille-test-mapped-cells.bin")) == expected );
+
+    Triangles t; // the boundary of the tetrahedra is a closed surface, remove two facets to open it
+    *t.points.data = *m.points.data;
+    t.create_facets(expected.size()/3 - 2);
+    for (int f : range(t.nfacets()))
+        for (int lv : range(3))
+            t.vert(f, lv) = expected[3*(f+2) + lv];
+    t.connect();
+    std::vector<int> border;
+    for (auto h : t.iter_halfedges())
+        if (h.on_boundary()) {
+            border.push_back(h.from());
+            border.push_back(h.to());
+        }
+    CHECK( !border.empty() );
+    write_mapped_array("ultimaille-test-mapped-cells.bin", t.facets);
+    CHECK( meter.boundary_edges(MappedArray<int>("ultimaille-test-mapped-cells.bin")) == border );
+}
+
+TEST_CASE("Mapped array with a truncated element", "[MappedArray]") {
+    std::vector<int> data = {1, 2, 3};
+    write_mapped_array("ultimaille-test-mapped.bin", data.data(), 7);
+    CHECK_THROWS_AS( MappedArray<int>("ultimaille-test-mapped.bin"), std::runtime_error );
+}
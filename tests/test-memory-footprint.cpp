@@ -0,0 +1,52 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ultimaille/all.h>
+
+using namespace UM;
+
+static size_t item(const MemoryFootprint &mf, const std::string &name) {
+    for (auto &it : mf.items)
+        if (it.name == name) return it.used;
+    return 0;
+}
+
+TEST_CASE("Memory footprint of a triangle mesh", "[MemoryFootprint]") {
+    Triangles m;
+    *m.points.data = {{0,0,0}, {1,0,0}, {0,1,0}, {1,1,0}};
+    m.facets = {0,1,2, 2,1,3};
+    PointAttribute<double> vdbl(m);
+    FacetAttribute<int> fint(m);
+    CornerAttribute<bool> cbool(m);
+
+    MemoryFootprint mf = m.memory_footprint();
+    CHECK( item(mf, "points") == 4*sizeof(vec3) );
+    CHECK( item(mf, "facets") == 6*sizeof(int) );
+    CHECK( item(mf, "point attributes") == 4*sizeof(double) );
+    CHECK( item(mf, "facet attributes") == 2*sizeof(int) );
+    CHECK( item(mf, "corner attributes") == 1 );
+    CHECK( item(mf, "connectivity") == 0 );
+    CHECK( mf.reserved() >= mf.used() );
+
+    m.connect(); // the connectivity is reported apart from the user attributes
+    mf = m.memory_footprint();
+    CHECK( item(mf, "connectivity") == 4*sizeof(int) + 6*sizeof(int) + 6*sizeof(int) + 1 );
+    CHECK( item(mf, "point attributes") == 4*sizeof(double) );
+    CHECK( item(mf, "facet attributes") == 2*sizeof(int) );
+
+    m.facets.reserve(1000);
+    CHECK( m.memory_footprint().reserved() - mf.reserved() == (m.facets.capacity()-6)*sizeof(int) );
+}
+
+TEST_CASE("Memory footprint of search structures", "[MemoryFootprint]") {
+    std::vector<vec3> pts(100);
+    KNN<3> knn(pts);
+    CHECK( knn.memory_footprint().used() == 100*sizeof(int) );
+
+    std::vector<BBox3> boxes(10);
+    HBoxes3 hb(boxes);
+    CHECK( hb.memory_footprint().used() >= 10*sizeof(BBox3) );
+
+    LOLMatrix lol = lol_identity(5);
+    CRSMatrix crs = lol.to_crs();
+    CHECK( item(lol.memory_footprint(), "values") == 5*sizeof(SparseElement) );
+    CHECK( crs.memory_footprint().used() == 5*sizeof(SparseElement) + 6*sizeof(int) );
+}
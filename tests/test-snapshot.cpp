@@ -0,0 +1,109 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ultimaille/all.h>
+
+using namespace UM;
+
+TEST_CASE("Snapshot and restore a triangle mesh", "[Snapshot]") {
+    Triangles m;
+    *m.points.data = {{0,0,0}, {1,0,0}, {0,1,0}, {1,1,0}};
+    m.facets = {0,1,2, 2,1,3};
+    PointAttribute<double> vdbl(m, 3.);
+    FacetAttribute<int> fint(m, 7);
+    m.connect();
+
+    Snapshot s = m.snapshot();
+    CHECK( m.snapshot().points == s.points ); // points did not change, the buffer is shared between the snapshots
+
+    m.points[3] = {2,2,2};
+    CHECK( (*s.points)[3].x == 1. );
+    vdbl[0] = -1.;
+    fint[1] = -7;
+
+    Snapshot s2 = m.snapshot();
+    CHECK( s2.elements == s.elements ); // facets did not change, the buffer is shared between the snapshots
+    CHECK( s2.points != s.points );
+
+    m.restore(s);
+    CHECK( m.points[3].x == 1. );
+    CHECK( vdbl[0] == 3. );
+    CHECK( fint[1] == 7 );
+
+    m.restore(s2);
+    CHECK( m.points[3].x == 2. );
+    CHECK( vdbl[0] == -1. );
+    CHECK( fint[1] == -7 );
+
+    m.restore(s);
+    m.conn->create_facet({0,3,2});      // topology change after the snapshot
+    FacetAttribute<double> fdbl(m, 1.); // attribute created after the snapshot
+    REQUIRE( m.nfacets() == 3 );
+    m.restore(s);
+    CHECK( m.nfacets() == 2 );
+    CHECK( fint.ptr->data.size() == 2 );
+    CHECK( fdbl.ptr->data.size() == 2 );
+    CHECK( m.conn->c2f.ptr->data.size() == 6 );
+    for (auto f : m.iter_facets())
+        for (auto h : f.iter_halfedges())
+            CHECK( h.facet() == f );
+}
+
+TEST_CASE("Snapshot and restore a polygon mesh", "[Snapshot]") {
+    Polygons m;
+    *m.points.data = {{0,0,0}, {1,0,0}, {1,1,0}, {0,1,0}, {2,0,0}};
+    m.create_facets(1, 4);
+    for (int lv=0; lv<4; lv++) m.vert(0, lv) = lv;
+    m.connect();
+
+    Snapshot s = m.snapshot();
+    m.conn->create_facet({1,4,2}); // both the facets and their offsets change
+    REQUIRE( m.nfacets() == 2 );
+    m.restore(s);
+    CHECK( m.nfacets() == 1 );
+    CHECK( m.facet_size(0) == 4 );
+    CHECK( m.conn->c2f.ptr->data.size() == 4 );
+    for (auto h : m.iter_halfedges()) {
+        CHECK( h.facet() == 0 );
+        CHECK( !h.opposite().active() );
+    }
+}
+
+TEST_CASE("Snapshot and restore a tet mesh", "[Snapshot]") {
+    Tetrahedra m;
+    *m.points.data = {{0,0,0}, {1,0,0}, {0,1,0}, {0,0,1}, {1,1,1}};
+    m.cells = {0,1,2,3, 1,2,3,4};
+    CellAttribute<int> cint(m, 1);
+
+    Snapshot s = m.snapshot();
+    std::vector<bool> to_kill = {true, false};
+    m.delete_cells(to_kill);
+    m.points[0] = {-1,-1,-1};
+    REQUIRE( m.ncells() == 1 );
+
+    m.restore(s);
+    CHECK( m.ncells() == 2 );
+    CHECK( cint.ptr->data.size() == 2 );
+    CHECK( m.points[0].x == 0. );
+}
+
+TEST_CASE("Parallel writes while a snapshot is alive", "[Snapshot]") {
+    PointSet pts;
+    pts.create_points(100000);
+    for (int v=0; v<pts.size(); v++)
+        pts[v] = {double(v), 0, 0};
+
+    Snapshot s = pts.snapshot();
+#pragma omp parallel for
+    for (int v=0; v<pts.size(); v++)
+        pts[v].y = 1.;
+    for (vec3 &p : pts) p.z = 2.;
+
+    bool ok = true;
+    for (int v=0; v<pts.size(); v++) {
+        ok = ok && (pts[v] - vec3(v, 1, 2)).norm2()==0;
+        ok = ok && ((*s.points)[v] - vec3(v, 0, 0)).norm2()==0;
+    }
+    CHECK( ok );
+
+    pts.restore(s);
+    CHECK( (pts[12345] - vec3(12345, 0, 0)).norm2()==0 );
+}
@@ -16,6 +16,40 @@ TEST_CASE("test_linexpr", "[LinExpr]") {
     }
 }
 
+TEST_CASE("LinExprBuilder", "[LinExpr]") {
+    LinExprBuilder b;
+    b += 7.;
+    b.add(X(6), -.1);
+    b -= X(2);
+    b += X(2)*(1.+1e-12);
+    b += X(3);
+    LinExpr le = b;
+    REQUIRE( le.size()==3 );
+    CHECK((le[0].index == -1 && le[0].value == 7.));
+    CHECK((le[1].index ==  3 && le[1].value == 1.));
+    CHECK((le[2].index ==  6 && le[2].value == -.1));
+
+    unsigned int seed = 1; // same result as repeated +=, bit for bit
+    auto rnd = [&seed]() { seed = seed*1103515245u + 12345u; return (seed>>8) & 0xffff; };
+    LinExpr eager;
+    b.clear();
+    for (int i=0; i<1000; i++) {
+        int v = rnd()%50 - 1;
+        double c = rnd()/1000. + .1;
+        if (i%3) {
+            eager += X(v)*c + 1.;
+            b += X(v)*c + 1.;
+        } else {
+            eager -= X(v)*c;
+            b.add(X(v), -c);
+        }
+    }
+    le = b;
+    REQUIRE( le.size() == eager.size() );
+    for (int i=0; i<le.size(); i++)
+        CHECK((le[i].index == eager[i].index && le[i].value == eager[i].value));
+}
+
 TEST_CASE("SparseVector operations", "[SparseVector]") {
     SECTION("Compact") {
         SparseVector vec = {{1, 3.1}, {3, 2.}, {5, -1e-14}, {6, 10.}, {3, 1.5}};
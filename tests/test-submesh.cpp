@@ -0,0 +1,76 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ultimaille/all.h>
+
+using namespace UM;
+
+TEST_CASE("Sub-mesh view over a triangle mesh", "[SubMeshView]") {
+    Triangles m; // 3x3 grid of vertices, 8 triangles
+    for (int j : range(3))
+        for (int i : range(3))
+            m.points.push_back({double(i), double(j), 0.});
+    for (int j : range(2))
+        for (int i : range(2)) {
+            int v = i+j*3;
+            m.facets.insert(m.facets.end(), {v, v+1, v+4, v, v+4, v+3});
+        }
+    FacetAttribute<int> region(m);
+    PointAttribute<double> height(m, 0.);
+    for (int f : range(m.nfacets()))
+        region[f] = m.points[m.vert(f, 0)].x < .5;
+
+    std::vector<int> subset;
+    for (int f : range(m.nfacets()))
+        if (region[f]) subset.push_back(f);
+    SubMeshView view(m, subset);
+    REQUIRE( view.nfacets() == 4 );
+    CHECK( view.nverts() == 6 );
+
+    for (int v : range(m.nverts())) {
+        int lv = view.local_vertex(v);
+        CHECK( (lv>=0) == (m.points[v].x < 1.5) );
+        if (lv>=0) CHECK( view.vertex(lv) == v );
+    }
+    for (int lf : range(view.nfacets())) {
+        CHECK( view.local_element(view.element(lf)) == lf );
+        for (int lv : range(3))
+            CHECK( view.vertex(view.local_vert(lf, lv)) == m.vert(view.element(lf), lv) );
+    }
+
+    auto local_height = view.per_vertex(height); // writes go to the parent storage
+    for (int v : range(view.nverts()))
+        local_height[v] = view.point(v).y + 1.;
+    for (int v : range(m.nverts()))
+        CHECK( height[v] == (m.points[v].x < 1.5 ? m.points[v].y + 1. : 0.) );
+
+    int cnt = 0;
+    for (auto f : view.iter_facets()) {
+        CHECK( region[f] );
+        CHECK( view.per_element(region)[cnt++] == 1 );
+    }
+    CHECK( cnt == 4 );
+    double area = 0;
+    for (auto f : view.iter_facets())
+        area += Triangle3(f).unsigned_area();
+    CHECK( std::abs(area-2.) < 1e-10 );
+}
+
+TEST_CASE("Sub-mesh view over a tet mesh", "[SubMeshView]") {
+    Tetrahedra m;
+    *m.points.data = {{0,0,0}, {1,0,0}, {0,1,0}, {0,0,1}, {1,1,1}};
+    m.cells = {0,1,2,3, 1,2,3,4};
+    CellAttribute<int> cint(m, 1);
+
+    SubMeshView view(m, {1});
+    REQUIRE( view.ncells() == 1 );
+    CHECK( view.vertices == std::vector<int>{1,2,3,4} );
+    CHECK( view.local_vertex(0) == -1 );
+    view.per_element(cint)[0] = 2;
+    CHECK( cint[0] == 1 );
+    CHECK( cint[1] == 2 );
+    for (auto c : view.iter_cells())
+        CHECK( c.nverts() == 4 );
+    int nv = 0;
+    for (auto v : view.iter_vertices())
+        CHECK( v == view.vertex(nv++) );
+    CHECK( nv == 4 );
+}
@@ -0,0 +1,177 @@
+#include <catch2/catch_test_macros.hpp>
+#include <random>
+#include <ultimaille/all.h>
+
+using namespace UM;
+
+TEST_CASE("voronoi 2d", "[voronoi]") {
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<double> rnd(0, 1);
+    const BBox2 domain({0, 0}, {1, 1});
+
+    const int m = 10; // regular grid: square cells
+    std::vector<vec2> grid;
+    for (int j=0; j<m; j++)
+        for (int i=0; i<m; i++)
+            grid.push_back({(i+.5)/m, (j+.5)/m});
+    std::vector<vec2> centroids;
+    std::vector<double> areas;
+    voronoi_centroids(grid, domain, centroids, areas);
+    for (int i=0; i<m*m; i++) {
+        CHECK( std::abs(areas[i] - 1./(m*m)) < 1e-12 );
+        CHECK( (centroids[i] - grid[i]).norm() < 1e-12 );
+    }
+
+    std::vector<vec2> seeds(5000);
+    for (vec2 &p : seeds) p = {rnd(gen), rnd(gen)};
+    Polygons voronoi;
+    voronoi_diagram(seeds, domain, voronoi);
+    REQUIRE( voronoi.nfacets() == static_cast<int>(seeds.size()) );
+    voronoi_centroids(seeds, domain, centroids, areas);
+    double total = 0;
+    for (int f=0; f<voronoi.nfacets(); f++) {
+        double area = 0;
+        vec2 closest = seeds[f];
+        for (int lv=0; lv<voronoi.facet_size(f); lv++) {
+            vec2 a = voronoi.points[voronoi.vert(f, lv)].xy(), b = voronoi.points[voronoi.vert(f, (lv+1)%voronoi.facet_size(f))].xy();
+            area += (a.x*b.y - a.y*b.x)/2.;
+            for (int j=0; j<static_cast<int>(seeds.size()); j++) // the vertices are equidistant to at least 2 seeds, none being closer
+                if ((seeds[j]-a).norm2() < (closest-a).norm2()) closest = seeds[j];
+            CHECK( (closest-a).norm() > (seeds[f]-a).norm() - 1e-9 );
+        }
+        CHECK( std::abs(area - areas[f]) < 1e-12 );
+        total += areas[f];
+    }
+    CHECK( std::abs(total - 1.) < 1e-9 );
+
+    auto energy = [&]() { // Lloyd iterations decrease the quantization error
+        double e = 0;
+        for (int i=0; i<static_cast<int>(seeds.size()); i++)
+            e += areas[i]*(centroids[i]-seeds[i]).norm2();
+        return e;
+    };
+    double before = energy();
+    for (int iter=0; iter<10; iter++) {
+        seeds = centroids;
+        voronoi_centroids(seeds, domain, centroids, areas);
+    }
+    CHECK( energy() < before );
+}
+
+TEST_CASE("convex cell 3d", "[voronoi]") {
+    ConvexCell3 cc(BBox3({0, 0, 0}, {1, 1, 1}));
+    double volume;
+    vec3 centroid;
+    cc.volume_centroid(volume, centroid);
+    CHECK( std::abs(volume - 1.) < 1e-12 );
+    CHECK( (centroid - vec3{.5, .5, .5}).norm() < 1e-12 );
+
+    cc.clip_by_plane({-1, 0, 0, .3}); // x <= .3
+    cc.volume_centroid(volume, centroid);
+    CHECK( std::abs(volume - .3) < 1e-12 );
+    CHECK( (centroid - vec3{.15, .5, .5}).norm() < 1e-12 );
+
+    cc.init(BBox3({0, 0, 0}, {1, 1, 1}));
+    cc.clip_by_plane({-1, -1, -1, 1}); // the corner tetrahedron x+y+z <= 1
+    cc.volume_centroid(volume, centroid);
+    CHECK( cc.nfaces() == 4 );
+    CHECK( std::abs(volume - 1./6.) < 1e-12 );
+    CHECK( (centroid - vec3{.25, .25, .25}).norm() < 1e-12 );
+
+    cc.clip_by_plane({1, 1, 1, -2}); // x+y+z >= 2
+    CHECK( cc.empty() );
+}
+
+TEST_CASE("restricted voronoi", "[voronoi]") {
+    Tetrahedra t; // L-shaped domain: 2x2x1 cubes minus one, each cube split into 6 tetrahedra
+    auto id = [](int i, int j, int k) { return i + j*3 + k*9; };
+    t.points.create_points(18);
+    for (int k=0; k<=1; k++)
+        for (int j=0; j<=2; j++)
+            for (int i=0; i<=2; i++)
+                t.points[id(i, j, k)] = {double(i), double(j), double(k)};
+    for (int j=0; j<2; j++)
+        for (int i=0; i<2; i++) {
+            if (i==1 && j==1) continue;
+            int perm[3] = {0, 1, 2};
+            do {
+                int c[3] = {i, j, 0};
+                t.cells.push_back(id(c[0], c[1], c[2]));
+                for (int d : perm) {
+                    c[d]++;
+                    t.cells.push_back(id(c[0], c[1], c[2]));
+                }
+            } while (std::next_permutation(perm, perm+3));
+        }
+
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> rnd(0, 1);
+    std::vector<vec3> seeds;
+    while (seeds.size() < 500) {
+        vec3 p = {2*rnd(gen), 2*rnd(gen), rnd(gen)};
+        if (p.x < 1 || p.y < 1) seeds.push_back(p);
+    }
+    std::vector<vec3> centroids;
+    std::vector<double> volumes;
+    restricted_voronoi_centroids(seeds, t, centroids, volumes);
+    double total = 0;
+    for (int i=0; i<static_cast<int>(seeds.size()); i++) {
+        total += volumes[i];
+        CHECK( volumes[i] > 0 );
+        CHECK( (centroids[i].x <= 1+1e-9 || centroids[i].y <= 1+1e-9) );
+    }
+    CHECK( std::abs(total - 3.) < 1e-9 );
+
+    // the cells far from the reentrant edge are not affected by the restriction
+    KNN<3> knn(seeds);
+    KNN<3>::Neighborhood nbh;
+    ConvexCell3 cc;
+    for (int i=0; i<static_cast<int>(seeds.size()); i++) {
+        if (seeds[i].x > .5 || seeds[i].y > .5) continue;
+        cc.init(BBox3({0, 0, 0}, {2, 2, 1}));
+        REQUIRE( voronoi_cell(knn, nbh, cc, seeds, i) );
+        double volume;
+        vec3 centroid;
+        cc.volume_centroid(volume, centroid);
+        bool far = true;
+        for (const vec3 &p : cc.pts) far = far && (p.x <= 1 || p.y <= 1);
+        if (!far) continue;
+        CHECK( std::abs(volume - volumes[i]) < 1e-9 );
+        CHECK( (centroid - centroids[i]).norm() < 1e-9 );
+    }
+}
+
+TEST_CASE("voronoi cells of a grid", "[voronoi]") { // many neighbors at the same distance, they straddle the successive searches
+    std::vector<vec2> seeds2d;
+    std::vector<vec3> seeds;
+    for (int i=0; i<6; i++)
+        for (int j=0; j<6; j++) {
+            seeds2d.push_back({double(i), double(j)});
+            for (int k=0; k<6; k++)
+                seeds.push_back({double(i), double(j), double(k)});
+        }
+    KNN<2> knn2d(seeds2d);
+    KNN<2>::Neighborhood nbh2d;
+    for (int i=0; i<static_cast<int>(seeds2d.size()); i++) {
+        ConvexCell cc({-.5, -.5}, {5.5, 5.5});
+        REQUIRE( voronoi_cell(knn2d, nbh2d, cc, seeds2d, i, 2) );
+        std::vector<vec2> verts;
+        cc.export_verts(verts);
+        double area = 0;
+        for (int v=0; v<static_cast<int>(verts.size()); v++)
+            area += cross(verts[v].xy0(), verts[(v+1)%verts.size()].xy0()).z/2.;
+        CHECK( std::abs(area - 1.) < 1e-12 );
+    }
+    KNN<3> knn(seeds);
+    KNN<3>::Neighborhood nbh;
+    ConvexCell3 cc;
+    for (int i=0; i<static_cast<int>(seeds.size()); i++) {
+        cc.init(BBox3({-.5, -.5, -.5}, {5.5, 5.5, 5.5}));
+        REQUIRE( voronoi_cell(knn, nbh, cc, seeds, i, 2) );
+        double volume;
+        vec3 centroid;
+        cc.volume_centroid(volume, centroid);
+        CHECK( std::abs(volume - 1.) < 1e-12 );
+        CHECK( (centroid - seeds[i]).norm() < 1e-12 );
+    }
+}
@@ -0,0 +1,59 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ultimaille/all.h>
+
+using namespace UM;
+
+static void cube(Triangles &m, const int n, const bool open_top) { // unit cube, outward-oriented, the faces are not welded
+    for (int d=0; d<3; d++)
+        for (int s=0; s<2; s++) {
+            if (open_top && d==2 && s==1) continue;
+            int u = (d+1)%3, v = (d+2)%3;
+            int off = m.points.create_points((n+1)*(n+1));
+            for (int j=0; j<=n; j++)
+                for (int i=0; i<=n; i++) {
+                    vec3 p;
+                    p[d] = s;
+                    p[u] = i/double(n);
+                    p[v] = j/double(n);
+                    m.points[off+i+j*(n+1)] = p;
+                }
+            for (int j=0; j<n; j++)
+                for (int i=0; i<n; i++) {
+                    int a = off+i+j*(n+1), b = a+1, c = a+n+2, e = a+n+1;
+                    if (s) m.facets.insert(m.facets.end(), {a, b, c, a, c, e}); // normal along +e_d
+                    else   m.facets.insert(m.facets.end(), {a, c, b, a, e, c});
+                }
+        }
+}
+
+TEST_CASE("winding number", "[winding number]") {
+    Triangles m;
+    cube(m, 8, false);
+    BVHTriangles bvh(m);
+    WindingNumber exact(bvh, std::numeric_limits<double>::infinity()), fast(bvh);
+
+    std::vector<vec3> pts;
+    for (int i=0; i<2000; i++) {
+        vec3 p = {rand()/(double)RAND_MAX*3-1, rand()/(double)RAND_MAX*3-1, rand()/(double)RAND_MAX*3-1};
+        bool near = false;
+        for (int d=0; d<3; d++) near = near || std::abs(p[d]) < .01 || std::abs(p[d]-1) < .01;
+        if (!near) pts.push_back(p);
+    }
+    std::vector<double> w;
+    fast.winding_numbers(pts, w);
+    for (int i=0; i<(int)pts.size(); i++) {
+        const vec3 &p = pts[i];
+        bool inside = p.x > 0 && p.y > 0 && p.z > 0 && p.x < 1 && p.y < 1 && p.z < 1;
+        CHECK( std::abs(exact.winding_number(p) - (inside ? 1. : 0.)) < 1e-8 );
+        CHECK( std::abs(w[i] - exact.winding_number(p)) < .05 );
+        CHECK( fast.inside(p) == inside );
+    }
+
+    Triangles open; // the top face is missing: points far from the hole are still classified
+    cube(open, 8, true);
+    BVHTriangles obvh(open);
+    WindingNumber ow(obvh);
+    CHECK(  ow.inside({.5, .5, .1}) );
+    CHECK( !ow.inside({.5, .5, -.5}) );
+    CHECK( std::abs(ow.winding_number({.5, .5, 1.}) - .5) < .1 ); // on the hole
+}
@@ -0,0 +1,219 @@
+#include <cmath>
+#include <vector>
+#include "predicates.h"
+
+namespace UM {
+    // unit roundoff of double precision and the error bounds of the floating point evaluations below (Shewchuk)
+    static constexpr double epsilon      = 1.1102230246251565e-16; // 2^-53
+    static constexpr double ccwerrboundA = (3.  +  16.*epsilon)*epsilon;
+    static constexpr double o3derrboundA = (7.  +  56.*epsilon)*epsilon;
+    static constexpr double iccerrboundA = (10. +  96.*epsilon)*epsilon;
+    static constexpr double isperrboundA = (16. + 224.*epsilon)*epsilon;
+
+    static int sign(const double x) {
+        return (x > 0) - (x < 0);
+    }
+
+    // Exact arithmetic: a real number is represented by an expansion, i.e. a sum of non-overlapping doubles
+    // sorted by increasing magnitude, zero components are eliminated (zero is the empty expansion).
+    typedef std::vector<double> Expansion;
+
+    static void two_sum(const double a, const double b, double &x, double &y) {
+        x = a + b;
+        double bv = x - a, av = x - bv;
+        y = (a - av) + (b - bv);
+    }
+
+    static void fast_two_sum(const double a, const double b, double &x, double &y) { // |a| >= |b|
+        x = a + b;
+        y = b - (x - a);
+    }
+
+    static void two_product(const double a, const double b, double &x, double &y) {
+        x = a * b;
+        y = std::fma(a, b, -x);
+    }
+
+    static Expansion diff(const double a, const double b) {
+        double x = a - b, bv = a - x, av = x + bv;
+        double y = (a - av) + (bv - b);
+        Expansion e;
+        if (y != 0) e.push_back(y);
+        if (x != 0) e.push_back(x);
+        return e;
+    }
+
+    static Expansion grow(const Expansion &e, const double b) {
+        Expansion h;
+        h.reserve(e.size() + 1);
+        double q = b;
+        for (double c : e) {
+            double hh;
+            two_sum(q, c, q, hh);
+            if (hh != 0) h.push_back(hh);
+        }
+        if (q != 0) h.push_back(q);
+        return h;
+    }
+
+    static Expansion operator+(const Expansion &e, const Expansion &f) {
+        Expansion h = e;
+        for (double c : f)
+            h = grow(h, c);
+        return h;
+    }
+
+    static Expansion operator-(const Expansion &e) {
+        Expansion h = e;
+        for (double &c : h) c = -c;
+        return h;
+    }
+
+    static Expansion operator-(const Expansion &e, const Expansion &f) {
+        return e + -f;
+    }
+
+    static Expansion scale(const Expansion &e, const double b) {
+        Expansion h;
+        if (e.empty() || b == 0) return h;
+        h.reserve(2*e.size());
+        double q, hh;
+        two_product(e[0], b, q, hh);
+        if (hh != 0) h.push_back(hh);
+        for (int i=1; i<static_cast<int>(e.size()); i++) {
+            double p1, p0, s;
+            two_product(e[i], b, p1, p0);
+            two_sum(q, p0, s, hh);
+            if (hh != 0) h.push_back(hh);
+            fast_two_sum(p1, s, q, hh);
+            if (hh != 0) h.push_back(hh);
+        }
+        if (q != 0) h.push_back(q);
+        return h;
+    }
+
+    static Expansion operator*(const Expansion &e, const Expansion &f) {
+        Expansion h;
+        for (double c : f)
+            h = h + scale(e, c);
+        return h;
+    }
+
+    static int sign(const Expansion &e) {
+        return e.empty() ? 0 : sign(e.back());
+    }
+
+    static Expansion det2(const Expansion &a, const Expansion &b, const Expansion &c, const Expansion &d) { // | a b |
+        return a*d - b*c;                                                                                  // | c d |
+    }
+
+    static Expansion det3(const Expansion u[3], const Expansion v[3], const Expansion w[3]) { // rows u, v, w
+        return u[0]*det2(v[1], v[2], w[1], w[2]) - u[1]*det2(v[0], v[2], w[0], w[2]) + u[2]*det2(v[0], v[1], w[0], w[1]);
+    }
+
+    static int orient2d_exact(const vec2 &a, const vec2 &b, const vec2 &c) {
+        return sign(det2(diff(b.x, a.x), diff(b.y, a.y), diff(c.x, a.x), diff(c.y, a.y)));
+    }
+
+    static int incircle_exact(const vec2 &a, const vec2 &b, const vec2 &c, const vec2 &d) {
+        Expansion r[3][3]; // rows (x, y, x^2+y^2) relative to d
+        const vec2 *p[3] = {&a, &b, &c};
+        for (int i=0; i<3; i++) {
+            r[i][0] = diff(p[i]->x, d.x);
+            r[i][1] = diff(p[i]->y, d.y);
+            r[i][2] = r[i][0]*r[i][0] + r[i][1]*r[i][1];
+        }
+        return sign(det3(r[0], r[1], r[2]));
+    }
+
+    static int orient3d_exact(const vec3 &a, const vec3 &b, const vec3 &c, const vec3 &d) {
+        Expansion r[3][3];
+        const vec3 *p[3] = {&b, &c, &d};
+        for (int i=0; i<3; i++)
+            for (int j=0; j<3; j++)
+                r[i][j] = diff((*p[i])[j], a[j]);
+        return sign(det3(r[0], r[1], r[2]));
+    }
+
+    static int insphere_exact(const vec3 &a, const vec3 &b, const vec3 &c, const vec3 &d, const vec3 &e) {
+        Expansion r[4][3], lift[4]; // rows (x, y, z, x^2+y^2+z^2) relative to e
+        const vec3 *p[4] = {&a, &b, &c, &d};
+        for (int i=0; i<4; i++) {
+            for (int j=0; j<3; j++)
+                r[i][j] = diff((*p[i])[j], e[j]);
+            lift[i] = r[i][0]*r[i][0] + r[i][1]*r[i][1] + r[i][2]*r[i][2];
+        }
+        // expansion of the 4x4 determinant along the lift column
+        Expansion det = lift[3]*det3(r[0], r[1], r[2]) - lift[2]*det3(r[3], r[0], r[1]) + lift[1]*det3(r[2], r[3], r[0]) - lift[0]*det3(r[1], r[2], r[3]);
+        return -sign(det);
+    }
+
+    int orient2d(const vec2 &a, const vec2 &b, const vec2 &c) {
+        double detleft  = (a.x - c.x)*(b.y - c.y);
+        double detright = (a.y - c.y)*(b.x - c.x);
+        double det = detleft - detright;
+        if (std::abs(det) > ccwerrboundA*(std::abs(detleft) + std::abs(detright)))
+            return sign(det);
+        return orient2d_exact(a, b, c);
+    }
+
+    int incircle(const vec2 &a, const vec2 &b, const vec2 &c, const vec2 &d) {
+        double adx = a.x - d.x, bdx = b.x - d.x, cdx = c.x - d.x;
+        double ady = a.y - d.y, bdy = b.y - d.y, cdy = c.y - d.y;
+        double bdxcdy = bdx*cdy, cdxbdy = cdx*bdy, alift = adx*adx + ady*ady;
+        double cdxady = cdx*ady, adxcdy = adx*cdy, blift = bdx*bdx + bdy*bdy;
+        double adxbdy = adx*bdy, bdxady = bdx*ady, clift = cdx*cdx + cdy*cdy;
+        double det = alift*(bdxcdy - cdxbdy) + blift*(cdxady - adxcdy) + clift*(adxbdy - bdxady);
+        double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy))*alift + (std::abs(cdxady) + std::abs(adxcdy))*blift + (std::abs(adxbdy) + std::abs(bdxady))*clift;
+        if (std::abs(det) > iccerrboundA*permanent)
+            return sign(det);
+        return incircle_exact(a, b, c, d);
+    }
+
+    int orient3d(const vec3 &a, const vec3 &b, const vec3 &c, const vec3 &d) {
+        double adx = a.x - d.x, bdx = b.x - d.x, cdx = c.x - d.x;
+        double ady = a.y - d.y, bdy = b.y - d.y, cdy = c.y - d.y;
+        double adz = a.z - d.z, bdz = b.z - d.z, cdz = c.z - d.z;
+        double bdxcdy = bdx*cdy, cdxbdy = cdx*bdy;
+        double cdxady = cdx*ady, adxcdy = adx*cdy;
+        double adxbdy = adx*bdy, bdxady = bdx*ady;
+        double det = adz*(bdxcdy - cdxbdy) + bdz*(cdxady - adxcdy) + cdz*(adxbdy - bdxady); // det(a-d, b-d, c-d) = -det(b-a, c-a, d-a)
+        double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy))*std::abs(adz) + (std::abs(cdxady) + std::abs(adxcdy))*std::abs(bdz) + (std::abs(adxbdy) + std::abs(bdxady))*std::abs(cdz);
+        if (std::abs(det) > o3derrboundA*permanent)
+            return -sign(det);
+        return orient3d_exact(a, b, c, d);
+    }
+
+    int insphere(const vec3 &a, const vec3 &b, const vec3 &c, const vec3 &d, const vec3 &e) {
+        double aex = a.x - e.x, bex = b.x - e.x, cex = c.x - e.x, dex = d.x - e.x;
+        double aey = a.y - e.y, bey = b.y - e.y, cey = c.y - e.y, dey = d.y - e.y;
+        double aez = a.z - e.z, bez = b.z - e.z, cez = c.z - e.z, dez = d.z - e.z;
+        double aexbey = aex*bey, bexaey = bex*aey, ab = aexbey - bexaey;
+        double bexcey = bex*cey, cexbey = cex*bey, bc = bexcey - cexbey;
+        double cexdey = cex*dey, dexcey = dex*cey, cd = cexdey - dexcey;
+        double dexaey = dex*aey, aexdey = aex*dey, da = dexaey - aexdey;
+        double aexcey = aex*cey, cexaey = cex*aey, ac = aexcey - cexaey;
+        double bexdey = bex*dey, dexbey = dex*bey, bd = bexdey - dexbey;
+        double abc = aez*bc - bez*ac + cez*ab;
+        double bcd = bez*cd - cez*bd + dez*bc;
+        double cda = cez*da + dez*ac + aez*cd;
+        double dab = dez*ab + aez*bd + bez*da;
+        double alift = aex*aex + aey*aey + aez*aez;
+        double blift = bex*bex + bey*bey + bez*bez;
+        double clift = cex*cex + cey*cey + cez*cez;
+        double dlift = dex*dex + dey*dey + dez*dez;
+        double det = (dlift*abc - clift*dab) + (blift*cda - alift*bcd);
+
+        double aezp = std::abs(aez), bezp = std::abs(bez), cezp = std::abs(cez), dezp = std::abs(dez);
+        double aexbeyp = std::abs(aexbey), bexaeyp = std::abs(bexaey), bexceyp = std::abs(bexcey), cexbeyp = std::abs(cexbey);
+        double cexdeyp = std::abs(cexdey), dexceyp = std::abs(dexcey), dexaeyp = std::abs(dexaey), aexdeyp = std::abs(aexdey);
+        double aexceyp = std::abs(aexcey), cexaeyp = std::abs(cexaey), bexdeyp = std::abs(bexdey), dexbeyp = std::abs(dexbey);
+        double permanent = ((cexdeyp + dexceyp)*bezp + (dexbeyp + bexdeyp)*cezp + (bexceyp + cexbeyp)*dezp)*alift
+                         + ((dexaeyp + aexdeyp)*cezp + (aexceyp + cexaeyp)*dezp + (cexdeyp + dexceyp)*aezp)*blift
+                         + ((aexbeyp + bexaeyp)*dezp + (bexdeyp + dexbeyp)*aezp + (dexaeyp + aexdeyp)*bezp)*clift
+                         + ((bexceyp + cexbeyp)*aezp + (cexaeyp + aexceyp)*bezp + (aexbeyp + bexaeyp)*cezp)*dlift;
+        if (std::abs(det) > isperrboundA*permanent)
+            return -sign(det); // N.B. abcd is negatively oriented for Shewchuk's orient3d
+        return insphere_exact(a, b, c, d, e);
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef __PREDICATES_H__
+#define __PREDICATES_H__
+
+#include "vec.h"
+
+namespace UM {
+    // Robust geometric predicates, the returned sign (-1, 0 or 1) is exact.
+    // The determinants are evaluated in floating point and the sign is certified by a static error bound
+    // (Shewchuk, Adaptive precision floating-point arithmetic and fast robust geometric predicates, 1997),
+    // the uncertain cases are recomputed in exact expansion arithmetic.
+
+    // > 0 if abc is counterclockwise, i.e. the sign of det(b-a, c-a)
+    int orient2d(const vec2 &a, const vec2 &b, const vec2 &c);
+
+    // > 0 if d is inside the circumcircle of abc, abc being counterclockwise
+    int incircle(const vec2 &a, const vec2 &b, const vec2 &c, const vec2 &d);
+
+    // sign of det(b-a, c-a, d-a), i.e. of geo::tet_volume(a, b, c, d)
+    int orient3d(const vec3 &a, const vec3 &b, const vec3 &c, const vec3 &d);
+
+    // > 0 if e is inside the circumsphere of abcd, abcd being positively oriented (orient3d(a, b, c, d) > 0)
+    int insphere(const vec3 &a, const vec3 &b, const vec3 &c, const vec3 &d, const vec3 &e);
+}
+
+#endif //__PREDICATES_H__
@@ -4,6 +4,7 @@
 #include <ultimaille/algebra/eigen.h>
 #include <ultimaille/algebra/svd.h>
 #include <ultimaille/algebra/covariance.h>
+#include <ultimaille/algebra/predicates.h>
 
 #include <ultimaille/sparse/vector.h>
 #include <ultimaille/sparse/matrix.h>
@@ -16,9 +17,17 @@
 #include <ultimaille/helpers/disjointset.h>
 #include <ultimaille/helpers/permutation.h>
 #include <ultimaille/helpers/hilbert_sort.h>
+#include <ultimaille/helpers/radix_sort.h>
 #include <ultimaille/helpers/hboxes.h>
 #include <ultimaille/helpers/knn.h>
+#include <ultimaille/helpers/dynamic_knn.h>
+#include <ultimaille/helpers/hash_grid.h>
 #include <ultimaille/helpers/bvh.h>
+#include <ultimaille/helpers/hausdorff.h>
+#include <ultimaille/helpers/winding_number.h>
+#include <ultimaille/helpers/voronoi.h>
+#include <ultimaille/helpers/delaunay.h>
+#include <ultimaille/helpers/mapped_array.h>
 
 #include <ultimaille/meter.h>
 
@@ -35,12 +44,16 @@
 
 #include <ultimaille/attributes.h>
 #include <ultimaille/pointset.h>
+#include <ultimaille/compact_pointset.h>
 #include <ultimaille/polyline.h>
 #include <ultimaille/surface.h>
 #include <ultimaille/volume.h>
 #include <ultimaille/volume_connectivity.h>
 #include <ultimaille/primitive_geometry.h>
 #include <ultimaille/attr_binding.h>
+#include <ultimaille/snapshot.h>
+#include <ultimaille/submesh.h>
+#include <ultimaille/memory_footprint.h>
 
 #include <stlbfgs.h>
 #include <OpenNL_psm/OpenNL_psm.h>
@@ -2,8 +2,12 @@
 #define __ATTRIBUTES_H__
 #include <vector>
 #include <memory>
+#include <string>
+#include <algorithm>
 #include <cassert>
 #include "pointset.h"
+#include "snapshot.h"
+#include "memory_footprint.h"
 //#include "polyline.h"
 //#include "surface.h"
 //#include "volume.h"
@@ -17,6 +21,9 @@ namespace UM {
     struct GenericAttributeContainer {
         virtual void resize(const int n) = 0;
         virtual void compress(const std::vector<int> &old2new) = 0;
+        virtual std::shared_ptr<const void> save() const = 0;          // see Snapshot
+        virtual void restore(const std::shared_ptr<const void> &saved) = 0;
+        virtual void memory_footprint(MemoryFootprint &mf, const std::string &name) const = 0; // adds the data buffer to mf
         virtual ~GenericAttributeContainer() = default;
     };
 
@@ -33,10 +40,27 @@ namespace UM {
             }
             resize(cnt);
         }
+        std::shared_ptr<const void> save() const {
+            return save_buffer(data, saved);
+        }
+        void restore(const std::shared_ptr<const void> &buffer) {
+            restore_buffer(data, *std::static_pointer_cast<const std::vector<T> >(buffer));
+        }
+        void memory_footprint(MemoryFootprint &mf, const std::string &name) const {
+            mf.add(name, data);
+        }
         std::vector<T> data;
         T default_value;
+        mutable std::weak_ptr<const std::vector<T> > saved = {}; // last snapshot of the data
     };
 
+    // accounts all alive attributes of a binding list under the same name, except for the containers listed in skip
+    inline void attributes_footprint(MemoryFootprint &mf, const std::string &name, const std::vector<std::weak_ptr<GenericAttributeContainer> > &attr, const std::vector<const GenericAttributeContainer *> &skip = {}) {
+        for (auto &wp : attr) if (auto spt = wp.lock())
+            if (std::find(skip.begin(), skip.end(), spt.get()) == skip.end())
+                spt->memory_footprint(mf, name);
+    }
+
     typedef std::pair<std::string, std::shared_ptr<GenericAttributeContainer> > NamedContainer;
     struct PointSetAttributes {
         std::vector<NamedContainer> points;
@@ -0,0 +1,55 @@
+#include "compact_pointset.h"
+#include "syntactic-sugar/assert.h"
+
+namespace UM {
+    CompactPointSet::CompactPointSet(const std::vector<vec3> &pts, STORAGE storage) : storage(storage), frame() {
+        if (storage==QUANTIZED16)
+            for (const vec3 &p : pts)
+                frame.add(p);
+        resize(pts.size());
+#pragma omp parallel for
+        for (int i=0; i<static_cast<int>(pts.size()); i++)
+            set(i, pts[i]);
+    }
+
+    int CompactPointSet::push_back(const vec3 &p) {
+        resize(size()+1);
+        set(size()-1, p);
+        return size()-1;
+    }
+
+    void CompactPointSet::resize(const int n) {
+        assert(n>=0);
+        if (storage==FLOAT32)
+            f32.resize(3*n, 0.f);
+        else {
+            um_assert(!frame.empty()); // the quantization frame must be known beforehand
+            q16.resize(3*n, 0);
+        }
+    }
+
+    void CompactPointSet::reserve(const int n) {
+        if (storage==FLOAT32) f32.reserve(3*n);
+        else q16.reserve(3*n);
+    }
+
+    void CompactPointSet::decode(PointSet &pts) const {
+        pts.resize(size());
+#pragma omp parallel for
+        for (int i=0; i<size(); i++)
+            (*pts.data)[i] = (*this)[i];
+    }
+
+    double CompactPointSet::precision() const {
+        if (storage==FLOAT32) { // half ulp of the largest coordinate
+            double maxc = 0;
+            for (float c : f32)
+                maxc = std::max<double>(maxc, std::abs(c));
+            return maxc*std::numeric_limits<float>::epsilon()*.5;
+        }
+        double maxe = 0;
+        for (int d : {0, 1, 2})
+            maxe = std::max(maxe, (frame.max[d]-frame.min[d])/QMAX*.5);
+        return maxe;
+    }
+}
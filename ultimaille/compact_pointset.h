@@ -0,0 +1,80 @@
+#ifndef __COMPACT_POINTSET_H__
+#define __COMPACT_POINTSET_H__
+#include <vector>
+#include <cstdint>
+#include "algebra/vec.h"
+#include "helpers/hboxes.h"
+#include "pointset.h"
+
+namespace UM {
+    // Read-mostly point cloud with reduced coordinate precision:
+    //  - FLOAT32     stores 3 floats per point (half the memory of a PointSet),
+    //  - QUANTIZED16 stores 3 16-bit fixed-point coordinates relative to a bounding box (a quarter of the memory).
+    // Points are decoded to vec3 on access, thus they are returned by value; use PointSet for in-place edition.
+    struct CompactPointSet {
+        enum STORAGE { FLOAT32=0, QUANTIZED16=1 };
+
+        CompactPointSet(STORAGE storage = FLOAT32, BBox3 frame = {}) : storage(storage), frame(frame) {}
+        CompactPointSet(const std::vector<vec3> &pts, STORAGE storage = FLOAT32); // the quantization frame is the bounding box of pts
+        CompactPointSet(const PointSet &pts, STORAGE storage = FLOAT32) : CompactPointSet(*pts.data, storage) {}
+
+        int size() const { return storage==FLOAT32 ? f32.size()/3 : q16.size()/3; }
+        inline vec3 operator[](const int i) const;
+        inline void set(const int i, const vec3 &p);
+        int push_back(const vec3 &p);
+        void resize(const int n);
+        void reserve(const int n);
+
+        void decode(PointSet &pts) const;
+        double precision() const; // maximum coordinate error introduced by the encoding
+
+        MemoryFootprint memory_footprint() const {
+            MemoryFootprint mf;
+            if (storage==FLOAT32) mf.add("points", f32);
+            else mf.add("points", q16);
+            return mf;
+        }
+
+        struct const_iterator {
+            const CompactPointSet &pts;
+            int i;
+            void operator++() { ++i; }
+            bool operator!=(const const_iterator& rhs) const { return i != rhs.i; }
+            vec3 operator*() const { return pts[i]; }
+        };
+        const_iterator begin() const { return {*this, 0}; }
+        const_iterator end()   const { return {*this, size()}; }
+
+        STORAGE storage;
+        BBox3 frame;                      // quantization frame, points outside of the frame are clamped
+        std::vector<float> f32 = {};         // FLOAT32 coordinates, xyz xyz ...
+        std::vector<std::uint16_t> q16 = {}; // QUANTIZED16 coordinates, xyz xyz ...
+        static constexpr double QMAX = 65535.;
+    };
+
+    inline vec3 CompactPointSet::operator[](const int i) const {
+        assert(i>=0 && i<size());
+        if (storage==FLOAT32)
+            return { f32[3*i], f32[3*i+1], f32[3*i+2] };
+        vec3 p;
+        for (int d : {0, 1, 2})
+            p[d] = frame.min[d] + q16[3*i+d] * ((frame.max[d]-frame.min[d])/QMAX);
+        return p;
+    }
+
+    inline void CompactPointSet::set(const int i, const vec3 &p) {
+        assert(i>=0 && i<size());
+        if (storage==FLOAT32) {
+            for (int d : {0, 1, 2})
+                f32[3*i+d] = static_cast<float>(p[d]);
+            return;
+        }
+        for (int d : {0, 1, 2}) {
+            double extent = frame.max[d]-frame.min[d];
+            double t = extent>0 ? (p[d]-frame.min[d])/extent : 0.;
+            q16[3*i+d] = static_cast<std::uint16_t>(std::lround(std::clamp(t, 0., 1.)*QMAX));
+        }
+    }
+}
+
+#endif //__COMPACT_POINTSET_H__
@@ -1,63 +1,177 @@
 #include <limits>
-#include <queue>
+#include <cmath>
+#include <tuple>
+#include <algorithm>
+#include <cassert>
+#include <utility>
 #include "ultimaille/primitive_geometry.h"
 #include "ultimaille/helpers/bvh.h"
 
 namespace UM {
 
-    BVHTriangles::BVHTriangles(const Triangles &mesh) : m(const_cast<Triangles &>(mesh)) {
-        std::vector<BBox3> bboxes(m.nfacets());
-        for (int f=0; f<m.nfacets(); f++)               // create boxes bounding
-            for (int lv=0; lv<m.facet_size(f); lv++)    // individual faces
-                bboxes[f].add(m.points[m.vert(f, lv)]);
-        init(bboxes);                                   // create the bounding volume hierarchy
-    }
-
-    inline double dist_segment(double a, double b, double x) {
-            return x < a ? a-x : (x > b ? x-b : 0.);
-    }
-
-    inline double dist2_box(const BBox3 &box, const vec3 &p) {
-        return vec3(
-                dist_segment(box.min.x, box.max.x, p.x),
-                dist_segment(box.min.y, box.max.y, p.y),
-                dist_segment(box.min.z, box.max.z, p.z)
-                ).norm2();
-    }
-
-    PointOnMesh BVHTriangles::nearest_point(vec3 p) {
-        double best_dist2 = std::numeric_limits<double>::max();
-        PointOnMesh best_point = {{m, 0}, {0,0,0}};
-
-        using QEl = std::pair<double, int>;
-        std::priority_queue<QEl, std::vector<QEl>, std::greater<QEl>> Q;
-        Q.emplace(0., 0);
-
-        while (!Q.empty() && Q.top().first < best_dist2) {
-            const int node = Q.top().second; Q.pop();
-            const int leaves = tree.size()  - m.nfacets();               // start offset for the leaves of the hierarchy
-            const int beg = 2*node + 1;                                  // start offset for the children nodes
-            const int end = std::min(                                    //   end offset for the children nodes
-                    2*node + 3,
-                    static_cast<int>(tree.size())
-                    );
-
-            for (int son = beg; son<end; son++) {                        // iterate through children boxes
-                if (son < leaves)                                        // if it is not a leaf, place it in the priority queue
-                    Q.emplace(dist2_box(tree[son], p), son);
-                else {
-                    Surface::Facet f = {m, tree_pos_to_org[son-leaves]}; // for the leaves we can directly compute
-                    vec3 nearest = Triangle3(f).nearest_point(p);        // the nearest point and compare it to the current best
-                    double dist2 = (p-nearest).norm2();
-                    if (best_dist2 > dist2) {
-                        best_dist2 = dist2;
-                        best_point = {f, nearest};
-                    }
+    PointOnMesh BVHTriangles::nearest_point(const vec3 &p, int &feature) const {
+        PointOnMesh nearest = nearest_point(p);
+        feature = -1;
+        if (nearest.f >= 0) primitive(nearest.f).nearest_point(p, feature); // N.B. cheaper than tracking the feature during the traversal
+        return nearest;
+    }
+
+    // slab test of the ray org + t*inv_dir^-1 against a box, t in [0, tmax]; returns the entry parameter or -1 if it misses
+    inline double ray_box(const BBox3 &box, const vec3 &org, const vec3 &inv_dir, const double tmax) {
+        double t0 = 0, t1 = tmax;
+        for (int d : {0, 1, 2}) {
+            bool neg = inv_dir[d] < 0; // N.B. no swap, so empty boxes (min > max) are missed
+            double a = ((neg ? box.max[d] : box.min[d])-org[d])*inv_dir[d];
+            double b = ((neg ? box.min[d] : box.max[d])-org[d])*inv_dir[d];
+            if (a > t0) t0 = a; // N.B. NaN comparisons are false, thus degenerate slabs are ignored
+            if (b < t1) t1 = b;
+        }
+        return t0 <= t1 ? t0 : -1.;
+    }
+
+    // Möller-Trumbore ray-triangle intersection; returns the ray parameter or -1 if it misses
+    inline double ray_triangle(const vec3 &A, const vec3 &B, const vec3 &C, const vec3 &org, const vec3 &dir) {
+        vec3 e1 = B-A, e2 = C-A;
+        vec3 pvec = cross(dir, e2);
+        double det = e1*pvec;
+        if (std::abs(det) < std::numeric_limits<double>::min()) return -1.; // the ray is parallel to the triangle
+        double inv_det = 1./det;
+        vec3 tvec = org-A;
+        double u = (tvec*pvec)*inv_det;
+        if (u < 0 || u > 1) return -1.;
+        vec3 qvec = cross(tvec, e1);
+        double v = (dir*qvec)*inv_det;
+        if (v < 0 || u+v > 1) return -1.;
+        double t = (e2*qvec)*inv_det;
+        return t >= 0 ? t : -1.;
+    }
+
+    // front-to-back traversal, stops at the first hit if any is true
+    static int cast_ray(const BVHTriangles &bvh, const vec3 &org, const vec3 &dir, double &tmax, const bool any) {
+        if (bvh.tree.empty()) return -1;
+        vec3 inv_dir = {1./dir.x, 1./dir.y, 1./dir.z};
+        int best = -1;
+        int stack[128]; // the tree depth is at most 33
+        int top = 0;
+        if (ray_box(bvh.tree[0], org, inv_dir, tmax) >= 0) stack[top++] = 0;
+        while (top) {
+            int node = stack[--top];
+            if (node >= bvh.offset) {
+                int f = bvh.tree_pos_to_org[node - bvh.offset];
+                Triangle3 tri = bvh.primitive(f);
+                double t = ray_triangle(tri[0], tri[1], tri[2], org, dir);
+                if (t >= 0 && t <= tmax) {
+                    tmax = t;
+                    best = f;
+                    if (any) return best;
                 }
+                continue;
+            }
+            int sons[2];
+            double tsons[2];
+            int nsons = 0;
+            for (int son=2*node+1; son<2*node+3 && son<static_cast<int>(bvh.tree.size()); son++) {
+                double t = ray_box(bvh.tree[son], org, inv_dir, tmax);
+                if (t < 0) continue;
+                sons[nsons] = son;
+                tsons[nsons++] = t;
             }
+            if (nsons==2 && tsons[0] < tsons[1]) { // push the farthest son first
+                std::swap(sons[0], sons[1]);
+                std::swap(tsons[0], tsons[1]);
+            }
+            for (int i=0; i<nsons; i++)
+                stack[top++] = sons[i];
         }
-        return best_point;
+        return best;
     }
 
-}
+    RayHit BVHTriangles::first_hit(const vec3 &org, const vec3 &dir, const double tmax) const {
+        double t = tmax;
+        int f = cast_ray(*this, org, dir, t, false);
+        return { f, f<0 ? -1. : t, f<0 ? org : org + t*dir };
+    }
+
+    bool BVHTriangles::any_hit(const vec3 &org, const vec3 &dir, const double tmax) const {
+        double t = tmax;
+        return cast_ray(*this, org, dir, t, true) >= 0;
+    }
+
+    void BVHTriangles::first_hit_batch(const std::vector<vec3> &orgs, const std::vector<vec3> &dirs, std::vector<int> &facet, std::vector<double> &t, const double tmax) const {
+        assert(orgs.size()==dirs.size());
+        const int nrays = orgs.size();
+        facet.resize(nrays);
+        t.resize(nrays);
+#pragma omp parallel for schedule(dynamic, 64)
+        for (int r=0; r<nrays; r++) {
+            t[r] = tmax;
+            facet[r] = cast_ray(*this, orgs[r], dirs[r], t[r], false);
+            if (facet[r] < 0) t[r] = -1.;
+        }
+    }
 
+    void BVHTriangles::any_hit_batch(const std::vector<vec3> &orgs, const std::vector<vec3> &dirs, std::vector<int> &hit, const double tmax) const {
+        assert(orgs.size()==dirs.size());
+        const int nrays = orgs.size();
+        hit.resize(nrays);
+#pragma omp parallel for schedule(dynamic, 64)
+        for (int r=0; r<nrays; r++) {
+            double t = tmax;
+            hit[r] = cast_ray(*this, orgs[r], dirs[r], t, true) >= 0;
+        }
+    }
+
+    SignedDistance::SignedDistance(const BVHTriangles &bvh) : bvh(bvh) {
+        const Triangles &m = bvh.m;
+        facet_normal.assign(m.nfacets(), vec3(0, 0, 0));
+        edge_normal.assign(m.ncorners(), vec3(0, 0, 0));
+        vertex_normal.assign(m.nverts(), vec3(0, 0, 0));
+
+        for (int f=0; f<m.nfacets(); f++) {
+            Triangle3 tri = bvh.primitive(f);
+            vec3 n = cross(tri[1]-tri[0], tri[2]-tri[0]);
+            if (n.norm() > 0) facet_normal[f] = n.normalized(); // degenerate facets contribute nothing
+            for (int lv=0; lv<3; lv++) {
+                vec3 e1 = tri[(lv+1)%3]-tri[lv];
+                vec3 e2 = tri[(lv+2)%3]-tri[lv];
+                double angle = std::atan2(cross(e1, e2).norm(), e1*e2);
+                vertex_normal[m.vert(f, lv)] += angle*facet_normal[f];
+            }
+        }
+
+        std::vector<std::tuple<int, int, int>> edges(m.ncorners()); // (smallest vertex, largest vertex, corner)
+        for (int f=0; f<m.nfacets(); f++)
+            for (int lv=0; lv<3; lv++) {
+                int v1 = m.vert(f, lv), v2 = m.vert(f, (lv+1)%3);
+                edges[m.corner(f, lv)] = {std::min(v1, v2), std::max(v1, v2), m.corner(f, lv)};
+            }
+        std::sort(edges.begin(), edges.end());
+        for (int beg=0, end=0; beg<static_cast<int>(edges.size()); beg=end) { // group the corners sharing the same edge
+            vec3 n = {0, 0, 0};
+            for (end=beg; end<static_cast<int>(edges.size()) && std::get<0>(edges[end])==std::get<0>(edges[beg]) && std::get<1>(edges[end])==std::get<1>(edges[beg]); end++)
+                n += facet_normal[std::get<2>(edges[end])/3];
+            for (int i=beg; i<end; i++)
+                edge_normal[std::get<2>(edges[i])] = n;
+        }
+    }
+
+    double SignedDistance::distance(const vec3 &p) const {
+        int feature;
+        PointOnMesh nearest = bvh.nearest_point(p, feature);
+        if (nearest.f < 0) return std::numeric_limits<double>::max();
+        vec3 n;
+        if (feature < 3)      n = vertex_normal[bvh.m.vert(nearest.f, feature)];
+        else if (feature < 6) n = edge_normal[bvh.m.corner(nearest.f, feature-3)];
+        else                  n = facet_normal[nearest.f];
+        vec3 d = p - nearest.p;
+        return d*n < 0 ? -d.norm() : d.norm();
+    }
+
+    void SignedDistance::distances(const std::vector<vec3> &pts, std::vector<double> &dist) const {
+        const int npts = pts.size();
+        dist.resize(npts);
+#pragma omp parallel for schedule(dynamic, 64)
+        for (int i=0; i<npts; i++)
+            dist[i] = distance(pts[i]);
+    }
+}
@@ -1,23 +1,188 @@
 #ifndef __BVH_H__
 #define __BVH_H__
 
+#include <limits>
+#include <vector>
+#include <utility>
+#include <concepts>
 #include "ultimaille/algebra/vec.h"
 #include "ultimaille/helpers/hboxes.h"
+#include "ultimaille/polyline.h"
 #include "ultimaille/surface.h"
+#include "ultimaille/volume.h"
+#include "ultimaille/primitive_geometry.h"
 
 namespace UM {
 
     struct PointOnMesh {
         inline operator vec3() const { return p; }
-        Surface::Facet f;
-        vec3 p;
+        int f = -1; // id of the primitive: facet, cell or edge
+        vec3 p = {};
     };
 
-    struct BVHTriangles : HBoxes<3> { // bounding volume hierarchy
-        BVHTriangles(const Triangles &m);
-        PointOnMesh nearest_point(vec3 p);
+    struct RayHit {
+        inline operator vec3() const { return p; }
+        bool hit() const { return f >= 0; }
+        int f = -1;   // facet id, -1 if the ray misses the mesh
+        double t = -1; // hit point is p = org + t*dir
+        vec3 p = {};
+    };
+
+    inline double dist_segment(double a, double b, double x) {
+            return x < a ? a-x : (x > b ? x-b : 0.);
+    }
+
+    inline double dist2_box(const BBox3 &box, const vec3 &p) {
+        return vec3(
+                dist_segment(box.min.x, box.max.x, p.x),
+                dist_segment(box.min.y, box.max.y, p.y),
+                dist_segment(box.min.z, box.max.z, p.z)
+                ).norm2();
+    }
+
+    // Bounding volume hierarchy over the primitives of a mesh: the edges of a PolyLine (Segment3), the facets
+    // of Triangles (Triangle3) or Quads (Quad3), the cells of Tetrahedra (Tetrahedron).
+    // The queries are const and allocation-free, they can be run concurrently on a shared BVH.
+    template <class M> struct BVH : HBoxes<3> {
+        static_assert(std::derived_from<M, PolyLine> || std::derived_from<M, Triangles> || std::derived_from<M, Quads> || std::derived_from<M, Tetrahedra>);
+        static constexpr bool is_volume = std::derived_from<M, Tetrahedra>;
+
+        BVH(const M &m, HBOXES_BUILD build = RECURSIVE_SORT) : m(m) {
+            init(primitive_boxes(), build);
+        }
+
+        int nprimitives() const {
+            if constexpr (std::derived_from<M, PolyLine>) return m.nedges();
+            else if constexpr (is_volume) return m.ncells();
+            else return m.nfacets();
+        }
+
+        auto primitive(const int i) const {
+            auto P = [this, i](const int lv) { return m.points[m.vert(i, lv)]; };
+            if constexpr (std::derived_from<M, PolyLine>) return Segment3{P(0), P(1)};
+            else if constexpr (std::derived_from<M, Triangles>) return Triangle3(P(0), P(1), P(2));
+            else if constexpr (std::derived_from<M, Quads>) return Quad3(P(0), P(1), P(2), P(3));
+            else return Tetrahedron(P(0), P(1), P(2), P(3));
+        }
+
+        std::vector<BBox3> primitive_boxes() const {
+            const int n = nprimitives();
+            const int size = std::derived_from<M, PolyLine> ? 2 : (std::derived_from<M, Triangles> ? 3 : 4);
+            std::vector<BBox3> bboxes(n);
+#pragma omp parallel for if (n > 4096)
+            for (int i=0; i<n; i++)
+                for (int lv=0; lv<size; lv++)
+                    bboxes[i].add(m.points[m.vert(i, lv)]);
+            return bboxes;
+        }
+
+        // update the hierarchy after the points of the mesh have moved (the primitives must not change), see HBoxes::refit()
+        bool refit(double max_degradation = 2.) { return HBoxes<3>::refit(primitive_boxes(), max_degradation); }
+
+        // nearest point on the primitives; for a volume, p itself if it is inside the mesh
+        PointOnMesh nearest_point(const vec3 &p) const {
+            PointOnMesh best;
+            if (tree.empty()) return best;
+            double best_dist2 = std::numeric_limits<double>::max();
+
+            std::pair<double, int> stack[128]; // (squared distance to the box, node), the tree depth is at most 33
+            int top = 0;
+            stack[top++] = {dist2_box(tree[0], p), 0};
+            while (top) { // depth-first traversal, the nearest son first; the subtrees farther than the current best are pruned
+                auto [box_dist2, node] = stack[--top];
+                if (box_dist2 >= best_dist2) continue;
+                if (node >= offset) {
+                    int i = tree_pos_to_org[node - offset];
+                    vec3 nearest = primitive(i).nearest_point(p);
+                    double dist2 = (p-nearest).norm2();
+                    if (dist2 < best_dist2) {
+                        best_dist2 = dist2;
+                        best = {i, nearest};
+                    }
+                    continue;
+                }
+                std::pair<double, int> sons[2];
+                int nsons = 0;
+                for (int son=2*node+1; son<2*node+3 && son<static_cast<int>(tree.size()); son++)
+                    sons[nsons++] = {dist2_box(tree[son], p), son};
+                if (nsons==2 && sons[0].first < sons[1].first) // push the farthest son first
+                    std::swap(sons[0], sons[1]);
+                for (int k=0; k<nsons; k++)
+                    stack[top++] = sons[k];
+            }
+            return best;
+        }
+
+        void nearest_points(const std::vector<vec3> &pts, std::vector<PointOnMesh> &nearest) const {
+            const int npts = pts.size();
+            nearest.resize(npts);
+#pragma omp parallel for schedule(dynamic, 64)
+            for (int i=0; i<npts; i++)
+                nearest[i] = nearest_point(pts[i]);
+        }
+
+        // early-out test: is there a primitive at distance < r from p
+        bool within(const vec3 &p, const double r) const {
+            const double r2 = r*r;
+            return traverse([&p, r2](const BBox3 &box) { return dist2_box(box, p) < r2; },
+                            [this, &p, r2](int i) { return (primitive(i).nearest_point(p) - p).norm2() < r2; });
+        }
+
+        // the cell containing p, -1 if p is outside the mesh
+        int locate(const vec3 &p) const requires is_volume {
+            int cell = -1;
+            traverse([&p](const BBox3 &box) { return box.contains(p); }, [this, &p, &cell](int c) {
+                if (!primitive(c).contains(p)) return false;
+                cell = c;
+                return true;
+            });
+            return cell;
+        }
+
+        void locate(const std::vector<vec3> &pts, std::vector<int> &cells) const requires is_volume {
+            const int npts = pts.size();
+            cells.resize(npts);
+#pragma omp parallel for schedule(dynamic, 64)
+            for (int i=0; i<npts; i++)
+                cells[i] = locate(pts[i]);
+        }
+
+        const M &m;
+    };
+
+    typedef BVH<PolyLine>   BVHSegments;
+    typedef BVH<Quads>      BVHQuads;
+    typedef BVH<Tetrahedra> BVHTetrahedra;
+
+    struct BVHTriangles : BVH<Triangles> {
+        BVHTriangles(const Triangles &m, HBOXES_BUILD build = RECURSIVE_SORT) : BVH<Triangles>(m, build) {}
+
+        using BVH<Triangles>::nearest_point;
+        PointOnMesh nearest_point(const vec3 &p, int &feature) const; // feature of the nearest facet, see Triangle3::nearest_point()
+
+        // ray casting over org + t*dir, t in [0, tmax]; dir does not need to be normalized
+        RayHit first_hit(const vec3 &org, const vec3 &dir, const double tmax = std::numeric_limits<double>::max()) const; // closest hit
+        bool any_hit(const vec3 &org, const vec3 &dir, const double tmax = std::numeric_limits<double>::max()) const;    // occlusion test
+
+        // batched ray casting: facet[r] is the facet hit by the ray r (-1 if none), t[r] the corresponding parameter
+        void first_hit_batch(const std::vector<vec3> &orgs, const std::vector<vec3> &dirs, std::vector<int> &facet, std::vector<double> &t, const double tmax = std::numeric_limits<double>::max()) const;
+        // hit[r] is 1 if the ray r hits the mesh, 0 otherwise
+        void any_hit_batch(const std::vector<vec3> &orgs, const std::vector<vec3> &dirs, std::vector<int> &hit, const double tmax = std::numeric_limits<double>::max()) const;
+    };
+
+    // Signed distance to a closed and consistently oriented triangulated surface, negative inside.
+    // The sign is given by the angle-weighted pseudo-normal of the nearest feature (facet, edge or vertex), see
+    // Baerentzen and Aanaes, Signed distance computation using the angle weighted pseudonormal, 2005.
+    // The normals are computed at construction, the structure must be rebuilt if the mesh moves.
+    struct SignedDistance {
+        SignedDistance(const BVHTriangles &bvh);
+        double distance(const vec3 &p) const;
+        void distances(const std::vector<vec3> &pts, std::vector<double> &dist) const;
 
-        Triangles &m; // TODO convert it to const ref
+        const BVHTriangles &bvh;
+        std::vector<vec3> facet_normal;  // unit normals, zero for degenerate facets
+        std::vector<vec3> edge_normal;   // per corner c, sum of the normals of the facets sharing the edge from c to the next corner
+        std::vector<vec3> vertex_normal; // sum of the normals of the incident facets weighted by their angle at the vertex
     };
 
 }
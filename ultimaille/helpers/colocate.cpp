@@ -1,34 +1,28 @@
+#include <cmath>
+#include <atomic>
+#include <cstdint>
+#include <bit>
 #include <algorithm>
 #include "ultimaille/helpers/knn.h"
 #include "ultimaille/helpers/colocate.h"
 
 namespace UM {
-    void colocate(const std::vector<vec3> &points, std::vector<int> &old2new, double tolerance) {
+    static void colocate_knn(const std::vector<vec3> &points, std::vector<int> &old2new, double tolerance) {
         int nb = points.size();
         old2new = std::vector<int>(nb, -1);
 
         KNN<3> knn(points);
 
-#pragma omp parallel for
-        for (int seed=0; seed<nb; seed++) {
-            int k = std::min<int>(6, nb);
-            while (1) {
-                std::vector<int> neighbors = knn.query(points[seed], k);
-
-                bool allfound = false;
-                int smallest = seed;
-                for (int i=0; i<k; i++) {
-                    double dist2 = (points[seed]-points[neighbors[i]]).norm2();
-                    if (dist2 > tolerance*tolerance) {
-                        allfound = true;
-                        break;
-                    }
-                    smallest = std::min<int>(smallest, neighbors[i]);
-                }
-                old2new[seed] = smallest;
-                if (allfound || k==nb) break;
-
-                k = std::min<int>(k+k/2, nb);
+#pragma omp parallel
+        {
+            std::vector<int> neighbors; // reused across the points
+#pragma omp for
+            for (int seed=0; seed<nb; seed++) {
+                neighbors.clear();
+                knn.radius_search(points[seed], tolerance*tolerance, neighbors);
+                old2new[seed] = seed;
+                for (int i : neighbors)
+                    old2new[seed] = std::min(old2new[seed], i);
             }
         }
 
@@ -41,5 +35,98 @@ namespace UM {
             old2new[i] = j;
         }
     }
-}
 
+    // lock-free union-find, the root of a set is its smallest element
+    struct ConcurrentDisjointSet {
+        ConcurrentDisjointSet(const int n) : parent(n) {
+#pragma omp parallel for
+            for (int i=0; i<n; i++) parent[i] = i;
+        }
+
+        int root(int i) {
+            while (1) {
+                int p = parent[i].load();
+                if (p == i) return i;
+                int gp = parent[p].load();
+                if (p != gp) parent[i].compare_exchange_weak(p, gp); // path halving
+                i = gp;
+            }
+        }
+
+        void merge(int a, int b) {
+            while (1) {
+                a = root(a);
+                b = root(b);
+                if (a == b) return;
+                if (a < b) std::swap(a, b);
+                if (parent[a].compare_exchange_strong(a, b)) return; // link the larger root under the smaller one
+            }
+        }
+
+        std::vector<std::atomic<int> > parent;
+    };
+
+    static void colocate_hash_grid(const std::vector<vec3> &points, std::vector<int> &old2new, double tolerance) {
+        const int nb = points.size();
+        const double cell = tolerance!=0 ? std::abs(tolerance) : 1.; // null tolerance: exact duplicates only
+        const uint64_t mask = std::bit_ceil(static_cast<uint64_t>(std::max(nb, 1))) - 1;
+
+        auto cell_of = [cell](const vec3 &p, const int d) { // clamped to +-2^62 (NaN goes to the lower bound) for a well-defined cast
+            constexpr double bound = 4611686018427387904.; // 2^62
+            double q = std::floor(p[d]/cell);
+            if (!(q > -bound)) q = -bound;
+            if (q > bound) q = bound;
+            return static_cast<int64_t>(q);
+        };
+        auto bucket_of = [mask](int64_t i, int64_t j, int64_t k) {
+            return (static_cast<uint64_t>(i)*73856093ULL ^ static_cast<uint64_t>(j)*19349663ULL ^ static_cast<uint64_t>(k)*83492791ULL) & mask;
+        };
+
+        // counting sort of the points by bucket
+        std::vector<int> bucket(nb);
+#pragma omp parallel for
+        for (int v=0; v<nb; v++)
+            bucket[v] = bucket_of(cell_of(points[v], 0), cell_of(points[v], 1), cell_of(points[v], 2));
+        std::vector<int> offset(mask+2, 0);
+        for (int v=0; v<nb; v++)
+            offset[bucket[v]+1]++;
+        for (uint64_t b=0; b<=mask; b++)
+            offset[b+1] += offset[b];
+        std::vector<std::atomic<int> > cursor(mask+1);
+#pragma omp parallel for
+        for (uint64_t b=0; b<=mask; b++)
+            cursor[b] = offset[b];
+        std::vector<int> sorted(nb);
+#pragma omp parallel for
+        for (int v=0; v<nb; v++)
+            sorted[cursor[bucket[v]]++] = v;
+
+        ConcurrentDisjointSet ds(nb);
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (int v=0; v<nb; v++) {
+            int64_t c[3] = { cell_of(points[v], 0), cell_of(points[v], 1), cell_of(points[v], 2) };
+            for (int64_t i=c[0]-1; i<=c[0]+1; i++)
+                for (int64_t j=c[1]-1; j<=c[1]+1; j++)
+                    for (int64_t k=c[2]-1; k<=c[2]+1; k++) {
+                        uint64_t b = bucket_of(i, j, k);
+                        for (int e=offset[b]; e<offset[b+1]; e++) { // N.B. the bucket may contain points from other cells
+                            int u = sorted[e];
+                            if (u < v && (points[u]-points[v]).norm2() <= tolerance*tolerance)
+                                ds.merge(u, v);
+                        }
+                    }
+        }
+
+        old2new.resize(nb);
+#pragma omp parallel for
+        for (int v=0; v<nb; v++)
+            old2new[v] = ds.root(v);
+    }
+
+    void colocate(const std::vector<vec3> &points, std::vector<int> &old2new, double tolerance, COLOCATE_METHOD method) {
+        if (method == HASH_GRID)
+            colocate_hash_grid(points, old2new, tolerance);
+        else
+            colocate_knn(points, old2new, tolerance);
+    }
+}
@@ -5,7 +5,14 @@
 #include "ultimaille/algebra/vec.h"
 
 namespace UM {
-    void colocate(const std::vector<vec3> &points, std::vector<int> &old2new, double tolerance);
+    // Maps every point to a representative point within the tolerance, i.e. old2new[i] is the smallest index of its cluster
+    //  - KNN_SEARCH: each point is mapped to the smallest index within the tolerance, then these maps are chained
+    //  - HASH_GRID:  points are bucketed in a hash grid of cell size tolerance and the pairs within the tolerance are merged
+    //                with a concurrent union-find; O(n) on average, best suited for welding large soups with a small tolerance.
+    //                The clusters are the connected components of the "within tolerance" relation.
+    // Both methods give the same result when the clusters are separated by more than the tolerance.
+    enum COLOCATE_METHOD { KNN_SEARCH=0, HASH_GRID=1 };
+    void colocate(const std::vector<vec3> &points, std::vector<int> &old2new, double tolerance, COLOCATE_METHOD method = KNN_SEARCH);
 }
 
 #endif // __COLOCATE_H__
@@ -0,0 +1,408 @@
+#include <array>
+#include <numeric>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#if defined(_OPENMP) && _OPENMP>=200805
+#include <omp.h>
+#endif
+#include "ultimaille/algebra/predicates.h"
+#include "ultimaille/helpers/hilbert_sort.h"
+#include "ultimaille/helpers/delaunay.h"
+#include "ultimaille/syntactic-sugar/assert.h"
+
+namespace UM {
+    static int orient(const vec2 *p[3]) { return orient2d(*p[0], *p[1], *p[2]); }
+    static int orient(const vec3 *p[4]) { return orient3d(*p[0], *p[1], *p[2], *p[3]); }
+    static int insphere(const vec2 *p[3], const vec2 &q) { return incircle(*p[0], *p[1], *p[2], q); }
+    static int insphere(const vec3 *p[4], const vec3 &q) { return insphere(*p[0], *p[1], *p[2], *p[3], q); }
+
+    // Triangulation of the whole space by simplices (triangles or tetrahedra) whose vertices are either points,
+    // or the vertex at infinity (-1). The simplices are positively oriented: the infinite simplices are
+    // the ones that become positive when their vertex at infinity is replaced by a point outside of the convex hull.
+    template<int D> struct DelaunayTriangulation {
+        static constexpr int N = D+1;    // vertices per simplex
+        static constexpr int DEAD = -2;  // marks the free simplices in vert[]
+
+        DelaunayTriangulation(const std::vector<vec<D> > &pts) : pts(pts) {}
+
+        // vertex k of the face opposite to lv, the face and the vertex lv form an even permutation of the simplex
+        static int face_vertex(const int lv, const int k) {
+            if constexpr (D==2) return (lv+1+k)%3;
+            constexpr int fv[4][3] = {{1,3,2}, {0,2,3}, {0,3,1}, {0,1,2}};
+            return fv[lv][k];
+        }
+
+        int infinite_vertex(const int s) const { // local index of the vertex at infinity, -1 for a finite simplex
+            for (int lv=0; lv<N; lv++)
+                if (vert[s*N+lv] < 0) return lv;
+            return -1;
+        }
+
+        int orient_subst(const int s, const int lv, const vec<D> &p) const { // orientation of s once its vertex lv is replaced by p
+            const vec<D> *P[N];
+            for (int i=0; i<N; i++)
+                P[i] = i==lv ? &p : &pts[vert[s*N+i]];
+            return orient(P);
+        }
+
+        bool conflict(const int s, const vec<D> &p) const { // is p in the circumsphere of s
+            int inf = infinite_vertex(s);
+            if (inf >= 0) { // the circumsphere is the half-space beyond the hull facet, plus its circumsphere if p lies on the hull facet
+                int o = orient_subst(s, inf, p);
+                if (o) return o > 0;
+                return conflict(adj[s*N+inf], p);
+            }
+            const vec<D> *P[N];
+            for (int i=0; i<N; i++)
+                P[i] = &pts[vert[s*N+i]];
+            return insphere(P, p) > 0; // N.B. cospherical points are not in conflict: the last inserted point is the most perturbed
+        }
+
+        // per-thread state: walk hint, recycled simplices and the scratch of insert()
+        struct Thread {
+            int id = 0;
+            int hint = 0;                // starting point of the walk, the last created simplex
+            uint32_t rng = 2463534242;
+            std::vector<int> free = {};  // dead simplices, reused by create_simplex()
+            std::vector<int> locked = {};
+            std::vector<int> cavity = {};
+            std::vector<int> created = {};
+            std::vector<std::pair<int, int> > boundary = {};
+            std::vector<std::pair<std::array<int, 3>, int> > ridges = {}; // (sorted face vertices, s*N+lv)
+            std::vector<int> table = {};
+        };
+
+        // a thread owns every simplex it reads or writes while inserting a point, the other threads give up on it
+        // and the point is inserted later by the sequential pass; without owner[], the insertion is sequential
+        bool lock(Thread &th, const int s) {
+            if (owner.empty()) return true;
+            int expected = 0;
+            if (owner[s].compare_exchange_strong(expected, th.id+1)) {
+                th.locked.push_back(s);
+                return true;
+            }
+            return expected == th.id+1;
+        }
+
+        void unlock_all(Thread &th) {
+            for (int s : th.locked)
+                owner[s] = 0;
+            th.locked.clear();
+        }
+
+        bool lock_conflict(Thread &th, const int s) { // conflict() reads the finite neighbor of the infinite simplices
+            if (!lock(th, s)) return false;
+            int inf = infinite_vertex(s);
+            return inf < 0 || lock(th, adj[s*N+inf]);
+        }
+
+        void reserve(const int capacity) { // the slots beyond nsimplices are dead
+            if (capacity <= static_cast<int>(mark.size())) return;
+            vert.resize(capacity*N, DEAD);
+            adj.resize(capacity*N, -1);
+            mark.resize(capacity, false);
+        }
+
+        int create_simplex(Thread &th) { // -1 if the capacity is exhausted or the recycled simplex is locked (parallel insertion only)
+            int s;
+            if (!th.free.empty()) {
+                s = th.free.back();
+                if (!lock(th, s)) return -1;
+                th.free.pop_back();
+            } else {
+                s = nsimplices++;
+                if (s >= static_cast<int>(mark.size())) {
+                    if (!owner.empty()) return -1;
+                    reserve(2*s+1);
+                }
+                if (!lock(th, s)) { // a random restart of locate() holds it
+                    th.free.push_back(s);
+                    return -1;
+                }
+            }
+            for (int lv=0; lv<N; lv++)
+                adj[s*N+lv] = -1;
+            return s;
+        }
+
+        // connects the faces opposite to the first D vertices of the simplices, they are shared by two of them
+        // the faces are matched by their (sorted) vertices in a small open addressing hash table
+        void link(Thread &th, const std::vector<int> &simplices) {
+            auto &ridges = th.ridges;
+            auto &table = th.table;
+            ridges.clear();
+            for (int s : simplices)
+                for (int k=0; k<D; k++) {
+                    std::array<int, 3> key = {-3, -3, -3};
+                    for (int j=0, cnt=0; j<N; j++)
+                        if (j!=k) key[cnt++] = vert[s*N+j];
+                    std::sort(key.begin(), key.begin()+D);
+                    ridges.push_back({key, s*N+k});
+                }
+            int size = 1;
+            while (size < 2*static_cast<int>(ridges.size())) size *= 2;
+            table.assign(size, -1);
+            for (int r=0; r<static_cast<int>(ridges.size()); r++) {
+                const std::array<int, 3> &key = ridges[r].first;
+                unsigned int h = (key[0]*73856093u ^ key[1]*19349663u ^ key[2]*83492791u) & (size-1);
+                while (table[h] >= 0 && ridges[table[h]].first != key)
+                    h = (h+1) & (size-1);
+                if (table[h] < 0) {
+                    table[h] = r;
+                    continue;
+                }
+                const int other = ridges[table[h]].second;
+                um_assert(adj[other] < 0);
+                adj[other] = ridges[r].second/N;
+                adj[ridges[r].second] = other/N;
+            }
+        }
+
+        // first simplex: the points of order are scanned until D+1 affinely independent points are found
+        bool init(Thread &th, const std::vector<int> &order, std::vector<bool> &inserted) {
+            std::array<int, N> v;
+            int nv = 0;
+            for (int i : order) {
+                if (nv==N) break;
+                const vec<D> &p = pts[i];
+                bool independent = false;
+                if (nv==0) independent = true;
+                else if (nv==1) independent = (p - pts[v[0]]).norm2() > 0;
+                else if constexpr (D==2) independent = orient2d(pts[v[0]], pts[v[1]], p) != 0;
+                else if (nv==2) { // not collinear: one of the projections on the coordinate planes is a non degenerate triangle
+                    const vec3 &a = pts[v[0]], &b = pts[v[1]];
+                    independent = orient2d({a.x, a.y}, {b.x, b.y}, {p.x, p.y}) || orient2d({a.y, a.z}, {b.y, b.z}, {p.y, p.z}) || orient2d({a.z, a.x}, {b.z, b.x}, {p.z, p.x});
+                } else
+                    independent = orient3d(pts[v[0]], pts[v[1]], pts[v[2]], p) != 0;
+                if (independent) v[nv++] = i;
+            }
+            if (nv < N) return false;
+
+            int s = create_simplex(th);
+            for (int lv=0; lv<N; lv++)
+                vert[s*N+lv] = v[lv];
+            if (orient_subst(s, 0, pts[v[0]]) < 0) // i.e. the orientation of s
+                std::swap(vert[s*N], vert[s*N+1]);
+            th.created.clear();
+            for (int lv=0; lv<N; lv++) { // one infinite simplex per facet, the facet is reversed
+                int t = create_simplex(th);
+                for (int k=0; k<D; k++)
+                    vert[t*N+k] = vert[s*N+face_vertex(lv, k)];
+                std::swap(vert[t*N], vert[t*N+1]);
+                vert[t*N+D] = -1;
+                adj[t*N+D] = s;
+                adj[s*N+lv] = t;
+                th.created.push_back(t);
+            }
+            link(th, th.created);
+            for (int lv=0; lv<N; lv++)
+                inserted[v[lv]] = true;
+            th.hint = s;
+            return true;
+        }
+
+        // visibility walk from the hint, the faces are tested in random order to avoid cycles
+        // -1 if the walk runs into a simplex owned by another thread
+        int locate(Thread &th, const vec<D> &p) {
+            int s = th.hint;
+            for (int attempt=0; !lock(th, s) || vert[s*N]==DEAD; attempt++) { // the hint was killed by another thread: random restart
+                if (attempt==8 && !owner.empty()) return -1;
+                th.rng ^= th.rng << 13; th.rng ^= th.rng >> 17; th.rng ^= th.rng << 5;
+                s = th.rng % std::min<int>(nsimplices, mark.size());
+            }
+            int inf = infinite_vertex(s);
+            if (inf >= 0) s = adj[s*N+inf];
+            while (true) {
+                if (!lock(th, s)) return -1;
+                if (infinite_vertex(s) >= 0) return s;
+                th.rng ^= th.rng << 13; th.rng ^= th.rng >> 17; th.rng ^= th.rng << 5; // xorshift32
+                const int r = th.rng % N;
+                int next = -1;
+                for (int k=0; k<N && next<0; k++) {
+                    int lv = (r+k)%N;
+                    if (orient_subst(s, lv, p) < 0) next = adj[s*N+lv];
+                }
+                if (next < 0) return s;
+                s = next;
+            }
+        }
+
+        enum { DUPLICATE = 0, INSERTED = 1, RETRY = 2 }; // RETRY: the cavity overlaps simplices owned by another thread
+
+        int insert(Thread &th, const int i) {
+            int status = insert_locked(th, i);
+            unlock_all(th);
+            return status;
+        }
+
+        int insert_locked(Thread &th, const int i) {
+            const vec<D> &p = pts[i];
+            int s = locate(th, p);
+            if (s < 0 || !lock_conflict(th, s)) return RETRY;
+            if (!conflict(s, p)) return DUPLICATE; // p is a vertex of s
+
+            auto &cavity = th.cavity;
+            auto &boundary = th.boundary;
+            auto &created = th.created;
+            auto abort = [&]() {
+                for (int t : cavity) mark[t] = false;
+                return RETRY;
+            };
+            cavity.assign(1, s);
+            mark[s] = true;
+            boundary.clear();
+            for (int c=0; c<static_cast<int>(cavity.size()); c++) {
+                int t = cavity[c];
+                for (int lv=0; lv<N; lv++) {
+                    int n = adj[t*N+lv];
+                    if (!lock_conflict(th, n)) return abort();
+                    if (mark[n]) continue;
+                    if (conflict(n, p)) {
+                        mark[n] = true;
+                        cavity.push_back(n);
+                    } else
+                        boundary.emplace_back(t, lv);
+                }
+            }
+
+            created.clear();
+            for (int b=0; b<static_cast<int>(boundary.size()); b++) { // nothing is modified before all simplices are allocated
+                int ns = create_simplex(th);
+                if (ns < 0) {
+                    th.free.insert(th.free.end(), created.begin(), created.end());
+                    return abort();
+                }
+                created.push_back(ns);
+            }
+            for (int b=0; b<static_cast<int>(boundary.size()); b++) { // star the cavity from p
+                auto [t, lv] = boundary[b];
+                int ns = created[b];
+                for (int k=0; k<D; k++)
+                    vert[ns*N+k] = vert[t*N+face_vertex(lv, k)];
+                vert[ns*N+D] = i;
+                int n = adj[t*N+lv];
+                adj[ns*N+D] = n;
+                for (int j=0; j<N; j++)
+                    if (adj[n*N+j]==t) adj[n*N+j] = ns;
+            }
+            link(th, created);
+
+            for (int t : cavity) {
+                mark[t] = false;
+                vert[t*N] = DEAD;
+                th.free.push_back(t);
+            }
+            th.hint = created.back();
+            return INSERTED;
+        }
+
+        // Points are inserted in BRIO order. The large rounds are inserted in parallel: each round is split into
+        // one contiguous (thus spatially coherent, see HilbertSort) slice per thread, the points whose cavity
+        // overlaps the region of another thread are set aside, then inserted by a sequential pass at the end of the round.
+        void run() {
+            const int n = pts.size();
+            std::vector<int> order(n);
+            std::iota(order.begin(), order.end(), 0);
+            std::vector<vec3> pts3(n); // HilbertSort works in 3D
+            for (int i=0; i<n; i++)
+                if constexpr (D==2) pts3[i] = pts[i].xy0();
+                else pts3[i] = pts[i];
+            std::vector<int> rounds = HilbertSort(pts3).brio(order);
+
+            int nthreads = 1;
+#if defined(_OPENMP) && _OPENMP>=200805
+            nthreads = omp_get_max_threads();
+#endif
+            std::vector<Thread> threads(nthreads);
+            for (int t=0; t<nthreads; t++) {
+                threads[t].id = t;
+                threads[t].rng += 7919u*t;
+            }
+            Thread &main = threads[0];
+
+            std::vector<bool> inserted(n, false);
+            if (!init(main, order, inserted)) return;
+            for (int r=0; r+1<static_cast<int>(rounds.size()); r++) {
+                const int begin = rounds[r], end = rounds[r+1];
+                if (nthreads==1 || end-begin < PARALLEL_CUTOFF) {
+                    for (int k=begin; k<end; k++)
+                        if (!inserted[order[k]]) insert(main, order[k]);
+                    continue;
+                }
+
+                reserve(nsimplices + (D==2 ? 3 : 8)*(end-begin) + 1024*nthreads); // about 2 triangles, 6.5 tetrahedra per point
+                owner = std::vector<std::atomic<int> >(mark.size());
+                std::vector<std::vector<int> > retry(nthreads);
+                for (int t=1; t<nthreads; t++) // each thread walks from its last insertion in the previous round
+                    if (vert[threads[t].hint*N]==DEAD) threads[t].hint = main.hint;
+#if defined(_OPENMP) && _OPENMP>=200805
+#pragma omp parallel num_threads(nthreads)
+#endif
+                {
+                    int t = 0;
+#if defined(_OPENMP) && _OPENMP>=200805
+                    t = omp_get_thread_num();
+#endif
+                    Thread &th = threads[t];
+                    const int slice = (end-begin + nthreads-1)/nthreads;
+                    for (int k=begin+t*slice; k<std::min(end, begin+(t+1)*slice); k++)
+                        if (!inserted[order[k]] && insert(th, order[k])==RETRY)
+                            retry[t].push_back(order[k]);
+                }
+                owner.clear();
+                nsimplices = std::min<int>(nsimplices, mark.size());
+                for (int t=0; t<nthreads; t++) // sequential pass over the interfaces between the slices
+                    for (int i : retry[t])
+                        insert(main, i);
+            }
+        }
+
+        template <class Mesh> void export_simplices(Mesh &m) const {
+            std::vector<int> simplices;
+            for (int s=0; s<nsimplices; s++)
+                if (vert[s*N]!=DEAD && infinite_vertex(s) < 0)
+                    simplices.push_back(s);
+            if constexpr (D==2) {
+                m.create_facets(simplices.size());
+                for (int f=0; f<static_cast<int>(simplices.size()); f++)
+                    for (int lv=0; lv<N; lv++)
+                        m.vert(f, lv) = vert[simplices[f]*N+lv];
+            } else {
+                m.create_cells(simplices.size());
+                for (int c=0; c<static_cast<int>(simplices.size()); c++)
+                    for (int lv=0; lv<N; lv++)
+                        m.vert(c, lv) = vert[simplices[c]*N+lv];
+            }
+        }
+
+        const std::vector<vec<D> > &pts;
+        std::vector<int> vert = {};  // N per simplex, -1 is the vertex at infinity
+        std::vector<int> adj = {};   // N per simplex, adj[s*N+lv] is the simplex across the face opposite to vert[s*N+lv]
+        std::vector<char> mark = {}; // per simplex, in the cavity of the point being inserted (char: written concurrently)
+        std::atomic<int> nsimplices = 0;
+        std::vector<std::atomic<int> > owner = {}; // per simplex, 1 + the thread that locked it, 0 if free (parallel rounds only)
+        static constexpr int PARALLEL_CUTOFF = 4096; // smaller rounds are inserted sequentially
+    };
+
+    void delaunay2d(const std::vector<vec2> &pts, Triangles &m) {
+        m.clear();
+        m.facets.clear();
+        m.points.create_points(pts.size());
+        for (int v=0; v<static_cast<int>(pts.size()); v++)
+            m.points[v] = pts[v].xy0();
+        DelaunayTriangulation<2> dt(pts);
+        dt.run();
+        dt.export_simplices(m);
+    }
+
+    void delaunay3d(const std::vector<vec3> &pts, Tetrahedra &m) {
+        m.clear();
+        m.points.create_points(pts.size());
+        for (int v=0; v<static_cast<int>(pts.size()); v++)
+            m.points[v] = pts[v];
+        DelaunayTriangulation<3> dt(pts);
+        dt.run();
+        dt.export_simplices(m);
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef __DELAUNAY_H__
+#define __DELAUNAY_H__
+
+#include <vector>
+#include "ultimaille/algebra/vec.h"
+#include "ultimaille/surface.h"
+#include "ultimaille/volume.h"
+
+namespace UM {
+    // Delaunay triangulation of a point set, incremental Bowyer-Watson algorithm:
+    // the points are inserted in BRIO order (see HilbertSort::brio), each point is located by a visibility walk
+    // starting from the last created simplex, then the simplices whose circumsphere contains it are replaced
+    // by a star around the point. The outside of the convex hull is covered by simplices incident to a vertex at infinity.
+    // The large BRIO rounds are inserted in parallel, one Hilbert slice per thread: a thread locks the simplices it walks through
+    // and the cavity of the point, the points whose cavity reaches a simplex locked by another thread are inserted sequentially afterwards.
+    // Robustness: orientation and in-sphere tests are exact (see predicates.h), degenerate configurations
+    // (cocircular/cospherical points) are resolved by a symbolic perturbation, the point inserted last being the most perturbed.
+    // m.points are the input points (duplicates are not referenced), the simplices are positively oriented.
+    // If the points are collinear (2D) or coplanar (3D), the output has no simplex.
+    void delaunay2d(const std::vector<vec2> &pts, Triangles &m);
+    void delaunay3d(const std::vector<vec3> &pts, Tetrahedra &m);
+}
+
+#endif //__DELAUNAY_H__
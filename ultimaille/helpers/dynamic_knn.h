@@ -0,0 +1,150 @@
+#ifndef __DYNAMIC_KNN_H__
+#define __DYNAMIC_KNN_H__
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "ultimaille/algebra/vec.h"
+#include "ultimaille/helpers/knn.h"
+
+namespace UM {
+    // k-nearest neighbors over a point set with interleaved insertions, deletions and queries.
+    // Logarithmic method: the points are spread over static KNN trees of sizes at most 1, 2, 4, ..., an insertion merges
+    // the small trees into the first empty level (O(log^2 n) amortized), a deletion only marks the point as dead.
+    // The whole structure is rebuilt when the dead points outnumber the alive ones. Queries are O(log^2 n) on average.
+    // Point ids are attributed by insert(): the id of an erased point is reused once the point was dropped from the trees,
+    // so the memory is proportional to the number of alive points, not to the total number of insertions.
+    template<int D> struct DynamicKNN {
+        DynamicKNN() = default;
+        DynamicKNN(const std::vector<vec<D> > &pts) {
+            for (const vec<D> &p : pts) {
+                points.push_back(p);
+                alive.push_back(true);
+            }
+            nalive = pts.size();
+            rebuild();
+        }
+
+        int size() const { return nalive; }
+        bool contains(const int id) const { return id>=0 && id<static_cast<int>(alive.size()) && alive[id]; }
+        const vec<D> &point(const int id) const { return points[id]; }
+
+        int insert(const vec<D> &p) {
+            int id;
+            if (free.empty()) {
+                id = points.size();
+                points.push_back(p);
+                alive.push_back(true);
+            } else {
+                id = free.back();
+                free.pop_back();
+                points[id] = p;
+                alive[id] = true;
+            }
+            nalive++;
+
+            int j = 0; // first empty level
+            while (j<static_cast<int>(levels.size()) && levels[j]) j++;
+            if (j==static_cast<int>(levels.size())) levels.emplace_back();
+            std::vector<int> ids = {id};
+            for (int l=0; l<j; l++) { // merge the smaller levels, dropping the dead points
+                for (int i : levels[l]->ids)
+                    if (alive[i]) ids.push_back(i);
+                    else {
+                        ndead--;
+                        free.push_back(i);
+                    }
+                levels[l].reset();
+            }
+            levels[j] = std::make_unique<Level>(*this, std::move(ids));
+            return id;
+        }
+
+        void erase(const int id) {
+            um_assert(contains(id));
+            alive[id] = false;
+            nalive--;
+            ndead++;
+            if (ndead > nalive) rebuild();
+        }
+
+        // k-nearest alive neighbors, sorted by increasing distance
+        std::vector<int> query(const vec<D> &p, const int k = 1) const {
+            typename KNN<D>::Neighborhood nbh;
+            nbh.reset(std::min(k, nalive));
+            if (nbh.k > 0)
+                for (auto &level : levels) if (level) {
+                    LevelNeighborhood lnbh{nbh, level->ids, alive};
+                    level->knn.search(lnbh, p, 0, level->knn.n, 0);
+                }
+            std::sort_heap(nbh.heap.begin(), nbh.heap.end());
+            std::vector<int> neighbors(nbh.heap.size());
+            for (int i=0; i<static_cast<int>(nbh.heap.size()); i++)
+                neighbors[i] = nbh.heap[i].second;
+            return neighbors;
+        }
+
+        // all the alive points at distance <= r from p, in no particular order
+        std::vector<int> radius_query(const vec<D> &p, const double r) const {
+            std::vector<int> neighbors, tmp;
+            for (auto &level : levels) if (level) {
+                tmp.clear();
+                level->knn.radius_search(p, r*r, tmp);
+                for (int i : tmp)
+                    if (alive[level->ids[i]]) neighbors.push_back(level->ids[i]);
+            }
+            return neighbors;
+        }
+
+        void rebuild() { // redistribute the alive points over the levels following the binary representation of their number
+            std::vector<int> ids;
+            free.clear();
+            for (int i=0; i<static_cast<int>(alive.size()); i++)
+                if (alive[i]) ids.push_back(i);
+                else free.push_back(i);
+            levels.clear();
+            ndead = 0;
+            int begin = 0;
+            for (int j=0; (1<<j)<=nalive; j++) {
+                levels.emplace_back();
+                if (!(nalive & (1<<j))) continue;
+                levels[j] = std::make_unique<Level>(*this, std::vector<int>(ids.begin()+begin, ids.begin()+begin+(1<<j)));
+                begin += 1<<j;
+            }
+        }
+
+        struct Level {
+            Level(const DynamicKNN &dknn, std::vector<int> &&ids) : ids(std::move(ids)), pts(extract(dknn, this->ids)), knn(pts) {}
+
+            static std::vector<vec<D> > extract(const DynamicKNN &dknn, const std::vector<int> &ids) {
+                std::vector<vec<D> > pts(ids.size());
+                for (int i=0; i<static_cast<int>(ids.size()); i++)
+                    pts[i] = dknn.points[ids[i]];
+                return pts;
+            }
+
+            std::vector<int> ids;      // level to global point ids
+            std::vector<vec<D> > pts;
+            KNN<D> knn;
+        };
+
+        // maps the level point ids to global ids and skips the dead points
+        struct LevelNeighborhood {
+            void insert(const double dist2, const int i) { if (alive[ids[i]]) nbh.insert(dist2, ids[i]); }
+            double bound() const { return nbh.bound(); }
+
+            typename KNN<D>::Neighborhood &nbh;
+            const std::vector<int> &ids;
+            const std::vector<bool> &alive;
+        };
+
+        std::vector<vec<D> > points = {};                  // indexed by id, the slots of the free ids are garbage
+        std::vector<bool> alive = {};
+        std::vector<int> free = {};                        // ids of dead points that are not stored in the levels anymore
+        std::vector<std::unique_ptr<Level> > levels = {};  // levels[j] holds at most 2^j points, or is empty
+        int nalive = 0;
+        int ndead = 0;                                     // dead points still stored in the levels
+    };
+}
+
+#endif //__DYNAMIC_KNN_H__
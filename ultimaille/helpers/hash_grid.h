@@ -0,0 +1,234 @@
+#ifndef __HASH_GRID_H__
+#define __HASH_GRID_H__
+
+#include <cmath>
+#include <array>
+#include <atomic>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include "ultimaille/algebra/vec.h"
+#include "ultimaille/helpers/knn.h"
+#include "ultimaille/helpers/hboxes.h"
+#include "ultimaille/memory_footprint.h"
+#include "ultimaille/syntactic-sugar/assert.h"
+
+namespace UM {
+    // Uniform grid over the bounding box of a point set, the non-empty cells are hashed into a table of buckets.
+    // Much faster to build than KNN or HBoxes, and faster to query for short-range neighborhoods, as long as
+    // the density is roughly uniform (blue-noise samplings, vertices of meshes with bounded edge length...).
+    // Points can be any random access container returning vec<D> (by value or by reference), e.g. PointSet.
+    // cell_size = 0 picks the cell size such that the non-empty cells hold about occupancy points on average.
+    template<int D, typename Points = std::vector<vec<D>>> struct HashGrid { // D=2 or D=3
+        HashGrid(const Points &points, const double cell_size = 0, const double occupancy = 2.) : pts(points), n(points.size()) {
+            um_assert(cell_size >= 0 && occupancy > 0);
+            for (int i=0; i<n; i++)
+                bbox.add(pts[i]);
+            origin = n ? bbox.min : vec<D>();
+            vec<D> extent = n ? bbox.size() : vec<D>();
+
+            double h = cell_size;
+            int dim = 0; // intrinsic dimension of the bounding box
+            if (h == 0) {
+                double volume = 1;
+                for (int d=0; d<D; d++)
+                    if (extent[d] > 0) {
+                        volume *= extent[d];
+                        dim++;
+                    }
+                h = dim ? std::pow(volume*occupancy/std::max(n, 1), 1./dim) : 1.;
+            }
+            for (int iter=0; ; iter++) {
+                build(h, occupancy);
+                if (cell_size > 0 || iter == 3) break;
+                int nonempty = 0;
+#pragma omp parallel for reduction(+:nonempty)
+                for (int b=0; b<static_cast<int>(offset.size())-1; b++)
+                    nonempty += offset[b+1] > offset[b];
+                double occ = n / static_cast<double>(std::max(nonempty, 1));
+                if (occ <= 2*occupancy) break;
+                // the points are concentrated on a lower dimensional subset, e.g. a surface in 3D
+                h *= std::pow(occupancy/occ, 1./std::max(1, dim-1));
+            }
+        }
+
+        void build(double h, const double occupancy) {
+            for (int d=0; d<D; d++) // at most 2^20 cells per dimension
+                h = std::max(h, (bbox.max[d] - bbox.min[d])/double(1<<20));
+            this->h = h;
+            for (int d=0; d<D; d++)
+                ncells[d] = n ? static_cast<int>(std::floor((bbox.max[d] - bbox.min[d])/h)) + 1 : 1;
+            bits = 1;
+            while ((uint64_t(1)<<bits) < 2*n/occupancy && bits < 30) bits++;
+            const int nbuckets = 1<<bits;
+
+            // counting sort of the points by bucket
+            std::vector<uint64_t> key_of(n);
+            std::vector<int> bucket_of(n);
+#pragma omp parallel for
+            for (int i=0; i<n; i++) {
+                key_of[i] = key(cell(pts[i]));
+                bucket_of[i] = bucket(key_of[i]);
+            }
+            offset.assign(nbuckets+1, 0);
+            for (int i=0; i<n; i++)
+                offset[bucket_of[i]+1]++;
+            for (int b=0; b<nbuckets; b++)
+                offset[b+1] += offset[b];
+            std::vector<std::atomic<int> > cursor(nbuckets);
+#pragma omp parallel for
+            for (int b=0; b<nbuckets; b++)
+                cursor[b] = offset[b];
+            sorted.resize(n);
+#pragma omp parallel for
+            for (int i=0; i<n; i++)
+                sorted[cursor[bucket_of[i]]++] = i;
+            sorted_keys.resize(n);
+            sorted_pts.resize(n);
+#pragma omp parallel for
+            for (int j=0; j<n; j++) {
+                sorted_keys[j] = key_of[sorted[j]];
+                sorted_pts[j] = pts[sorted[j]];
+            }
+        }
+
+        std::array<int, D> cell(const vec<D> &p) const { // clamped to the grid
+            std::array<int, D> c;
+            for (int d=0; d<D; d++)
+                c[d] = static_cast<int>(std::clamp(std::floor((p[d] - origin[d])/h), 0., double(ncells[d]-1)));
+            return c;
+        }
+
+        uint64_t key(const std::array<int, D> &c) const { // linear index of the cell
+            uint64_t k = 0;
+            for (int d=D; d--;)
+                k = k*ncells[d] + c[d];
+            return k;
+        }
+
+        int bucket(const uint64_t key) const { // Fibonacci hashing
+            return static_cast<int>((key*0x9E3779B97F4A7C15ULL) >> (64-bits));
+        }
+
+        // calls f(i, p) for the points i of the cell c, p being the position of i
+        template <class F> void for_each_point(const std::array<int, D> &c, F const &f) const {
+            uint64_t k = key(c);
+            int b = bucket(k);
+            for (int j=offset[b]; j<offset[b+1]; j++)
+                if (sorted_keys[j] == k) // N.B. the bucket may contain points from other cells
+                    f(sorted[j], sorted_pts[j]);
+        }
+
+        // calls f(c) for the cells c in [lo, hi]
+        template <class F> static void for_each_cell(const std::array<int, D> &lo, const std::array<int, D> &hi, F const &f) {
+            std::array<int, D> c = lo;
+            for (int d=0; d<D; d++)
+                if (lo[d] > hi[d]) return;
+            while (1) {
+                f(c);
+                int d = 0;
+                for (; d<D && c[d]==hi[d]; d++) c[d] = lo[d];
+                if (d==D) return;
+                c[d]++;
+            }
+        }
+
+        // all the points at distance <= r from p, in no particular order
+        std::vector<int> radius_query(const vec<D> &p, const double r) const {
+            std::vector<int> neighbors;
+            radius_search(p, r*r, neighbors);
+            return neighbors;
+        }
+
+        // appends to out all the points at squared distance <= r2 from p
+        void radius_search(const vec<D> &p, const double r2, std::vector<int> &out) const {
+            if (!n) return;
+            double r = std::sqrt(r2);
+            vec<D> shift;
+            for (int d=0; d<D; d++) shift[d] = r;
+            for_each_cell(cell(p-shift), cell(p+shift), [&](const std::array<int, D> &c) {
+                for_each_point(c, [&](int i, const vec<D> &x) { if ((x-p).norm2() <= r2) out.push_back(i); });
+            });
+        }
+
+        // all the points inside the box, in no particular order
+        std::vector<int> box_query(const BBox<D> &box) const {
+            std::vector<int> inside;
+            if (!n || box.empty()) return inside;
+            for_each_cell(cell(box.min), cell(box.max), [&](const std::array<int, D> &c) {
+                for_each_point(c, [&](int i, const vec<D> &x) { if (box.contains(x)) inside.push_back(i); });
+            });
+            return inside;
+        }
+
+        // k-nearest neighbors sorted by increasing distance, the cells are visited in rings of growing radius around p
+        std::vector<int> query(const vec<D> &p, const int k = 1) const {
+            typename KNN<D>::Neighborhood nbh;
+            search(nbh, p, k);
+            std::vector<int> neighbors(nbh.heap.size());
+            for (int i=0; i<static_cast<int>(nbh.heap.size()); i++)
+                neighbors[i] = nbh.heap[i].second;
+            return neighbors;
+        }
+
+        // calls f(cc) for the cells cc of the grid at Chebyshev distance r from c, O(r^(D-1)) cells
+        template <class F> void for_each_ring_cell(const std::array<int, D> &c, const int r, F const &f) const {
+            if (r==0) return f(c);
+            for (int d=0; d<D; d++) { // the two faces orthogonal to d, without the cells already visited with the faces of the dimensions e<d
+                std::array<int, D> lo, hi;
+                for (int e=0; e<D; e++) {
+                    lo[e] = std::max(c[e]-r+(e<d), 0);
+                    hi[e] = std::min(c[e]+r-(e<d), ncells[e]-1);
+                }
+                for (int x : {c[d]-r, c[d]+r}) {
+                    if (x<0 || x>=ncells[d]) continue;
+                    lo[d] = hi[d] = x;
+                    for_each_cell(lo, hi, f);
+                }
+            }
+        }
+
+        void search(typename KNN<D>::Neighborhood &nbh, const vec<D> &p, const int k) const {
+            nbh.reset(std::min(k, n));
+            std::array<int, D> c = cell(p);
+            for (int r=0; nbh.k > 0; r++) {
+                for_each_ring_cell(c, r, [&](const std::array<int, D> &cc) {
+                    for_each_point(cc, [&](int i, const vec<D> &x) { nbh.insert((x-p).norm2(), i); });
+                });
+                // distance from p to the cells not visited yet, the sides of the rings that reached the border of the grid do not count
+                double margin = std::numeric_limits<double>::max();
+                for (int d=0; d<D; d++) {
+                    if (c[d]-r > 0)            margin = std::min(margin, p[d] - (origin[d] + (c[d]-r)*h));
+                    if (c[d]+r < ncells[d]-1)  margin = std::min(margin, origin[d] + (c[d]+r+1)*h - p[d]);
+                }
+                if (margin == std::numeric_limits<double>::max()) break; // the whole grid was visited
+                if (margin > 0 && static_cast<int>(nbh.heap.size())==nbh.k && nbh.heap.front().first <= margin*margin) break;
+            }
+            std::sort_heap(nbh.heap.begin(), nbh.heap.end());
+        }
+
+        MemoryFootprint memory_footprint() const { // the points are not owned by the grid
+            MemoryFootprint mf;
+            mf.add("buckets", offset);
+            mf.add("point ids", sorted);
+            mf.add("cell ids", sorted_keys);
+            mf.add("coordinates", sorted_pts);
+            return mf;
+        }
+
+        const Points &pts;
+        const int n;
+        BBox<D> bbox = {};
+        vec<D> origin = {};
+        double h = 1;                        // cell size
+        std::array<int, D> ncells = {};      // number of cells per dimension
+        int bits = 1;                        // log2 of the number of buckets
+        std::vector<int> offset = {};        // the points of the bucket b are sorted[offset[b]..offset[b+1]-1]
+        std::vector<int> sorted = {};
+        std::vector<uint64_t> sorted_keys = {}; // cell of the point sorted[j]
+        std::vector<vec<D> > sorted_pts = {};   // copy of the points in the order of the buckets, for cache-friendly scans
+    };
+}
+
+#endif //__HASH_GRID_H__
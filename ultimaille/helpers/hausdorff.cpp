@@ -0,0 +1,72 @@
+#include <cmath>
+#include <atomic>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "ultimaille/helpers/bvh.h"
+#include "ultimaille/helpers/hausdorff.h"
+
+namespace UM {
+    static void atomic_max(std::atomic<double> &a, const double v) {
+        double cur = a.load(std::memory_order_relaxed);
+        while (v > cur && !a.compare_exchange_weak(cur, v, std::memory_order_relaxed));
+    }
+
+    SurfaceDistance one_sided_distance(const Triangles &from, const Triangles &to, const int nsamples, PointAttribute<double> *vertex_distance, const bool max_only) {
+        SurfaceDistance result;
+        if (!to.nfacets()) return result;
+        BVHTriangles bvh(to);
+
+        // stratified area sampling
+        std::vector<double> cumulated(from.nfacets()+1, 0.);
+        for (int f=0; f<from.nfacets(); f++) {
+            Triangle3 tri(from.points[from.vert(f, 0)], from.points[from.vert(f, 1)], from.points[from.vert(f, 2)]);
+            cumulated[f+1] = cumulated[f] + tri.unsigned_area();
+        }
+        std::vector<vec3> samples;
+        if (from.nfacets() && cumulated.back() > 0) {
+            samples.resize(nsamples);
+            std::mt19937 rng(0);
+            std::uniform_real_distribution<double> uniform(0., 1.);
+            for (int i=0; i<nsamples; i++) {
+                double t = (i + uniform(rng))/nsamples*cumulated.back();
+                int f = std::clamp(static_cast<int>(std::upper_bound(cumulated.begin(), cumulated.end(), t) - cumulated.begin()) - 1, 0, from.nfacets()-1);
+                double r1 = std::sqrt(uniform(rng)), r2 = uniform(rng); // uniform point in the triangle
+                samples[i] = (1-r1)*from.points[from.vert(f, 0)] + r1*(1-r2)*from.points[from.vert(f, 1)] + r1*r2*from.points[from.vert(f, 2)];
+            }
+        }
+
+        std::atomic<double> max = 0;
+        const int nverts = from.nverts();
+#pragma omp parallel for schedule(dynamic, 64)
+        for (int v=0; v<nverts; v++) { // the vertices first, they are likely to give a good initial bound
+            double d = (bvh.nearest_point(from.points[v]).p - from.points[v]).norm();
+            if (vertex_distance) (*vertex_distance)[v] = d;
+            atomic_max(max, d);
+        }
+
+        const int ns = samples.size();
+        double sum = 0, sum2 = 0;
+#pragma omp parallel for schedule(dynamic, 64) reduction(+:sum,sum2)
+        for (int i=0; i<ns; i++) {
+            if (max_only && bvh.within(samples[i], max.load(std::memory_order_relaxed))) continue; // cannot increase the max
+            double d = (bvh.nearest_point(samples[i]).p - samples[i]).norm();
+            atomic_max(max, d);
+            sum  += d;
+            sum2 += d*d;
+        }
+
+        result.max = max;
+        if (!max_only && ns) {
+            result.mean = sum/ns;
+            result.rms  = std::sqrt(sum2/ns);
+        }
+        return result;
+    }
+
+    SurfaceDistance hausdorff_distance(const Triangles &a, const Triangles &b, const int nsamples, PointAttribute<double> *a_to_b, PointAttribute<double> *b_to_a, const bool max_only) {
+        SurfaceDistance ab = one_sided_distance(a, b, nsamples, a_to_b, max_only);
+        SurfaceDistance ba = one_sided_distance(b, a, nsamples, b_to_a, max_only);
+        return { std::max(ab.max, ba.max), (ab.mean + ba.mean)/2, std::sqrt((ab.rms*ab.rms + ba.rms*ba.rms)/2) };
+    }
+}
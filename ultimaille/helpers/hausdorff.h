@@ -0,0 +1,29 @@
+#ifndef __HAUSDORFF_H__
+#define __HAUSDORFF_H__
+
+#include "ultimaille/surface.h"
+#include "ultimaille/attributes.h"
+
+namespace UM {
+    // Statistics of the distance from the points of a surface to another surface
+    struct SurfaceDistance {
+        double max  = 0; // Hausdorff distance
+        double mean = 0; // area-weighted averages
+        double rms  = 0;
+    };
+
+    // One-sided distance from the surface "from" to the surface "to", estimated on nsamples points of "from"
+    // (stratified w.r.t. the area: the i-th sample is drawn in the i-th slice of the cumulated facet areas)
+    // plus its vertices. The nearest points are queried in parallel on a BVH of "to".
+    // vertex_distance: if not null, receives the distance from each vertex of "from" to "to"
+    // max_only: the mean and rms are not computed (left to 0), the samples that cannot increase the running max
+    //           are then discarded by an early-out test instead of a full nearest point query
+    SurfaceDistance one_sided_distance(const Triangles &from, const Triangles &to, const int nsamples = 100000,
+                                       PointAttribute<double> *vertex_distance = nullptr, const bool max_only = false);
+
+    // Symmetric distance: the max of both one-sided maxima, the mean (quadratic mean) of their means (rms)
+    SurfaceDistance hausdorff_distance(const Triangles &a, const Triangles &b, const int nsamples = 100000,
+                                       PointAttribute<double> *a_to_b = nullptr, PointAttribute<double> *b_to_a = nullptr, const bool max_only = false);
+}
+
+#endif //__HAUSDORFF_H__
@@ -5,9 +5,14 @@
 
 #include <vector>
 #include <limits>
+#include <utility>
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include "ultimaille/algebra/vec.h"
+#include "ultimaille/memory_footprint.h"
+#include "ultimaille/helpers/radix_sort.h"
+#include "ultimaille/syntactic-sugar/assert.h"
 
 namespace UM {
 
@@ -88,6 +93,11 @@ namespace UM {
             return ans ;
     }
 
+    // How HBoxes::init() orders the primitives along the leaves:
+    // RECURSIVE_SORT: sort the box centers along the largest dimension, split, recurse (better trees)
+    // MORTON_SORT:    radix sort of the Morton codes of the box centers (much faster build, looser boxes, for large sets)
+    enum HBOXES_BUILD { RECURSIVE_SORT=0, MORTON_SORT=1 };
+
     /**
      * Store bounding boxes as hierarchical tree of boxes
     */
@@ -95,11 +105,20 @@ namespace UM {
         
         HBoxes() {}
 
-        HBoxes(std::vector<BBox<n>> const &boxes) {
+        HBoxes(std::vector<BBox<n>> const &boxes, HBOXES_BUILD build = RECURSIVE_SORT) {
+            init(boxes, build);
+        }
+
+        void init(std::vector<BBox<n>> const &boxes, HBOXES_BUILD build) {
+            this->build = build;
             init(boxes);
         }
 
         void init(std::vector<BBox<n>> const &boxes) {
+            if (build == MORTON_SORT) {
+                init_morton(boxes);
+                return;
+            }
             int nboxes = boxes.size();
             std::vector<vec<n>> G(nboxes);
             // Implicit binary tree:
@@ -124,17 +143,135 @@ namespace UM {
             // + number of added boxes (nodes)
             tree.resize(offset + nboxes);
 
-            // Add leaves at the right place using indirection map
+            // Add leaves at the right place using indirection map,
+            // then nodes following the pattern of implicit binary tree
+            refit_nodes(boxes);
+            build_cost = cost();
+        }
+
+        // Same implicit layout as the recursive sort: since the aligned power of two ranges of the leaves
+        // are the subtrees, the Morton order directly gives spatially coherent nodes.
+        void init_morton(std::vector<BBox<n>> const &boxes) {
+            const int nboxes = boxes.size();
+            std::vector<vec<n>> G(nboxes);
+#pragma omp parallel for
+            for (int b=0; b<nboxes; b++)
+                G[b] = boxes[b].center();
+            BBox<n> range;
+            for (int b=0; b<nboxes; b++)
+                range.add(G[b]);
+
+            constexpr int bits = n==1 ? 32 : 63/n; // bits per dimension
+            constexpr double quanta = static_cast<double>((uint64_t(1)<<bits) - 1);
+            vec<n> scale;
+            for (int d=0; d<n; d++)
+                scale[d] = range.max[d] > range.min[d] ? quanta/(range.max[d] - range.min[d]) : 0.;
+            std::vector<uint64_t> keys(nboxes);
+            tree_pos_to_org.resize(nboxes);
+#pragma omp parallel for
+            for (int b=0; b<nboxes; b++) {
+                uint64_t q[n];
+                for (int d=0; d<n; d++)
+                    q[d] = static_cast<uint64_t>(std::clamp((G[b][d] - range.min[d])*scale[d], 0., quanta));
+                keys[b] = morton_code(q);
+                tree_pos_to_org[b] = b;
+            }
+            radix_sort(keys, tree_pos_to_org);
+
+            offset = static_cast<int>(std::pow(2., 1. + mylog2(nboxes))) - 1;
+            tree.resize(offset + nboxes);
+            refit_nodes(boxes);
+            build_cost = cost();
+        }
+
+        // interleave the bits of the quantized coordinates
+        static uint64_t morton_code(uint64_t const (&q)[n]) {
+            if constexpr (n==1) {
+                return q[0];
+            } else if constexpr (n==2) {
+                auto spread = [](uint64_t x) { // 32 bits, one every 2 bits
+                    x &= 0xffffffff;
+                    x = (x | x<<16) & 0x0000ffff0000ffff;
+                    x = (x | x<<8)  & 0x00ff00ff00ff00ff;
+                    x = (x | x<<4)  & 0x0f0f0f0f0f0f0f0f;
+                    x = (x | x<<2)  & 0x3333333333333333;
+                    x = (x | x<<1)  & 0x5555555555555555;
+                    return x;
+                };
+                return spread(q[0]) | spread(q[1])<<1;
+            } else if constexpr (n==3) {
+                auto spread = [](uint64_t x) { // 21 bits, one every 3 bits
+                    x &= 0x1fffff;
+                    x = (x | x<<32) & 0x001f00000000ffff;
+                    x = (x | x<<16) & 0x001f0000ff0000ff;
+                    x = (x | x<<8)  & 0x100f00f00f00f00f;
+                    x = (x | x<<4)  & 0x10c30c30c30c30c3;
+                    x = (x | x<<2)  & 0x1249249249249249;
+                    return x;
+                };
+                return spread(q[0]) | spread(q[1])<<1 | spread(q[2])<<2;
+            } else {
+                uint64_t code = 0;
+                for (int bit=0; bit<63/n; bit++)
+                    for (int d=0; d<n; d++)
+                        code |= ((q[d]>>bit) & 1) << (bit*n + d);
+                return code;
+            }
+        }
+
+        // Update the boxes of the primitives (same number, same order as in init()) without changing the tree structure.
+        // Leaves are updated in parallel, then the nodes level by level, from the deepest one up to the root.
+        // Since the tree is not re-sorted, its quality degrades as the boxes move: it is rebuilt from scratch when the
+        // total area of its nodes (relative to the root) has grown by more than max_degradation since the last init().
+        // Returns true if the tree has been rebuilt.
+        bool refit(std::vector<BBox<n>> const &boxes, double max_degradation = 2.) {
+            um_assert(static_cast<int>(boxes.size()) == static_cast<int>(tree.size()) - offset);
+            refit_nodes(boxes);
+            if (cost() <= max_degradation*build_cost) return false;
+            init(boxes);
+            return true;
+        }
+
+        // set the leaves from the boxes following tree_pos_to_org, then the nodes bottom-up
+        void refit_nodes(std::vector<BBox<n>> const &boxes) {
+            const int nboxes = boxes.size();
+#pragma omp parallel for
             for (int b=0; b<nboxes; b++)
                 tree[offset + b] = boxes[tree_pos_to_org[b]];
-            // Add nodes at the right place following the pattern of implicit binary tree
-            for (int i=offset; i--;) {
-                for (int son = 2*i+1; son<2*i+3; son++)
-                    if (son < static_cast<int>(tree.size()))
-                        tree[i].add(tree[son]);
+            for (int level=mylog2(offset+1); level--;) { // nodes of the level l are [2^l-1, 2^(l+1)-1)
+                const int beg = (1<<level) - 1, end = (2<<level) - 1;
+#pragma omp parallel for if (end-beg > 1024)
+                for (int i=beg; i<end; i++) {
+                    tree[i] = BBox<n>();
+                    for (int son = 2*i+1; son<2*i+3; son++)
+                        if (son < static_cast<int>(tree.size()))
+                            tree[i].add(tree[son]);
+                }
             }
         }
 
+        // quality measure of the tree: sum of the areas of the nodes divided by the area of the root
+        double cost() const {
+            auto area = [](const BBox<n> &b) { // half of the surface area, the length for n=1
+                if (b.empty()) return 0.;
+                if (n==1) return b.max[0] - b.min[0];
+                double sum = 0;
+                for (int d=0; d<n; d++) {
+                    double prod = 1;
+                    for (int e=0; e<n; e++)
+                        if (e!=d) prod *= b.max[e] - b.min[e];
+                    sum += prod;
+                }
+                return sum;
+            };
+            double root = area(tree[0]);
+            if (root <= 0) return 0;
+            double sum = 0;
+            for (int i=0; i<offset; i++)
+                sum += area(tree[i]);
+            return sum / root;
+        }
+
         // Sort a slice of the indirection array
         void sort(std::vector<vec<n>> &G, int org, int dest) const {
             // Create a bounding box that encompass underlying bounding boxes
@@ -162,35 +299,176 @@ namespace UM {
             // 0   16 32   48
             int m = org + static_cast<int>(pow(2., mylog2(dest-org-1)));
     #if defined(_OPENMP) && _OPENMP>=200805
-    #pragma omp task
+    #pragma omp task shared(G) if (dest-org > 1024) // N.B. G would be firstprivate (i.e. copied) by default
     #endif
             // Sort nodes boxes
             sort(G, org, m);
     #if defined(_OPENMP) && _OPENMP>=200805
-    #pragma omp task
+    #pragma omp task shared(G) if (dest-org > 1024)
     #endif
             // Sort leaves boxes
             sort(G, m, dest);
         }
 
-        void intersect(BBox<n> const &b, std::vector<int> &primitives, int node=0) const {
-            if (!node) primitives.resize(0);
-            assert(node>=0 && node < static_cast<int>(tree.size()));
-            if (!tree[node].intersect(b)) return;
-            if (node >= offset)
-                primitives.push_back(tree_pos_to_org[node - offset]);
-            else {
-                for (int son=2*node+1; son<2*node+3; son++)
+        // all the primitives whose box intersects b
+        void intersect(BBox<n> const &b, std::vector<int> &primitives) const {
+            primitives.resize(0);
+            traverse([&b](const BBox<n> &box) { return box.intersect(b); }, [&primitives](int prim) { primitives.push_back(prim); return false; });
+        }
+
+        // all the primitives whose box contains p
+        void contains(vec<n> const &p, std::vector<int> &primitives) const {
+            primitives.resize(0);
+            traverse([&p](const BBox<n> &box) { return box.contains(p); }, [&primitives](int prim) { primitives.push_back(prim); return false; });
+        }
+
+        // early-out variants: one primitive whose box intersects b (contains p), -1 if there is none
+        int first_hit(BBox<n> const &b) const {
+            int hit = -1;
+            traverse([&b](const BBox<n> &box) { return box.intersect(b); }, [&hit](int prim) { hit = prim; return true; });
+            return hit;
+        }
+
+        int first_hit(vec<n> const &p) const {
+            int hit = -1;
+            traverse([&p](const BBox<n> &box) { return box.contains(p); }, [&hit](int prim) { hit = prim; return true; });
+            return hit;
+        }
+
+        bool any_hit(BBox<n> const &b) const { return first_hit(b) >= 0; }
+        bool any_hit(vec<n> const &p) const { return first_hit(p) >= 0; }
+
+        // intersection of a batch of boxes, the result is in compressed row storage:
+        // the primitives intersecting boxes[q] are primitives[offset[q]..offset[q+1]-1]
+        void intersect_batch(std::vector<BBox<n>> const &boxes, std::vector<int> &offset, std::vector<int> &primitives) const {
+            constexpr int block = 1024;
+            const int nq = boxes.size();
+            const int nblocks = (nq+block-1)/block;
+            std::vector<std::vector<int>> found(nblocks); // one buffer per block of queries
+            offset.assign(nq+1, 0);
+#pragma omp parallel for schedule(dynamic)
+            for (int blk=0; blk<nblocks; blk++)
+                for (int q=blk*block; q<std::min(nq, (blk+1)*block); q++) {
+                    const BBox<n> &b = boxes[q];
+                    traverse([&b](const BBox<n> &box) { return box.intersect(b); }, [&](int prim) { found[blk].push_back(prim); offset[q+1]++; return false; });
+                }
+
+            std::vector<int> block_offset(nblocks+1, 0);
+            for (int blk=0; blk<nblocks; blk++)
+                block_offset[blk+1] = block_offset[blk] + found[blk].size();
+            for (int q=0; q<nq; q++)
+                offset[q+1] += offset[q];
+            primitives.resize(block_offset.back());
+#pragma omp parallel for
+            for (int blk=0; blk<nblocks; blk++)
+                std::copy(found[blk].begin(), found[blk].end(), primitives.begin() + block_offset[blk]);
+        }
+
+        // depth-first traversal with an explicit stack: the subtrees whose box fails the overlap test are skipped,
+        // visit(primitive) is called on the remaining leaves, it returns true to stop the traversal
+        template <class Overlap, class Visit> bool traverse(Overlap const &overlap, Visit const &visit) const {
+            if (tree.empty()) return false;
+            int stack[128]; // the tree depth is at most 33
+            int top = 0;
+            stack[top++] = 0;
+            while (top) {
+                int node = stack[--top];
+                if (!overlap(tree[node])) continue;
+                if (node >= offset) {
+                    if (visit(tree_pos_to_org[node - offset])) return true;
+                    continue;
+                }
+                for (int son=2*node+2; son>2*node; son--) // the left son is visited first
                     if (son < static_cast<int>(tree.size()))
-                        intersect(b, primitives, son);
+                        stack[top++] = son;
             }
+            return false;
+        }
+
+        MemoryFootprint memory_footprint() const {
+            MemoryFootprint mf;
+            mf.add("boxes", tree);
+            mf.add("primitive ids", tree_pos_to_org);
+            return mf;
         }
 
         int offset = -1;
+        HBOXES_BUILD build = RECURSIVE_SORT;
+        double build_cost = 0; // cost() right after the last init()
         mutable std::vector<int> tree_pos_to_org = {};
         std::vector<BBox<n>> tree = {};
     };
 
+    // Dual-tree traversal over the pairs of nodes (na of a, nb of b) whose boxes intersect.
+    // self: a and b are the same tree, only the pairs of distinct primitives (i, j) with i<j are reported
+    template<int n> void overlapping_pairs(const HBoxes<n> &a, const HBoxes<n> &b, std::vector<std::pair<int, int>> &pairs, const bool self) {
+        pairs.resize(0);
+        if (a.tree.empty() || b.tree.empty()) return;
+        auto sons = [](const HBoxes<n> &h, int node, int *res) { // children of a node, the node itself if it is a leaf
+            if (node >= h.offset) { res[0] = node; return 1; }
+            int cnt = 0;
+            for (int son=2*node+1; son<2*node+3; son++)
+                if (son < static_cast<int>(h.tree.size()))
+                    res[cnt++] = son;
+            return cnt;
+        };
+        auto expand = [&](int na, int nb, auto emit, auto push) {
+            if (!a.tree[na].intersect(b.tree[nb])) return;
+            bool leafa = na >= a.offset, leafb = nb >= b.offset;
+            if (leafa && leafb) {
+                if (self && na == nb) return;
+                int pa = a.tree_pos_to_org[na - a.offset], pb = b.tree_pos_to_org[nb - b.offset];
+                if (self) emit(std::min(pa, pb), std::max(pa, pb));
+                else emit(pa, pb);
+                return;
+            }
+            int sa[2], sb[2];
+            int nsa = sons(a, na, sa), nsb = sons(b, nb, sb);
+            for (int i=0; i<nsa; i++)
+                for (int j=0; j<nsb; j++)
+                    if (!self || na != nb || sa[i] <= sb[j]) // the pairs of sons of the same node are taken once
+                        push(sa[i], sb[j]);
+        };
+
+        // breadth-first expansion of the first levels to get enough independent tasks
+        std::vector<std::pair<int, int>> frontier = {{0, 0}}, next;
+        while (!frontier.empty() && frontier.size() < 1024) {
+            next.resize(0);
+            bool progress = false;
+            for (auto [na, nb] : frontier) {
+                if (na >= a.offset && nb >= b.offset) { next.emplace_back(na, nb); continue; }
+                progress = true;
+                expand(na, nb, [](int, int) {}, [&next](int i, int j) { next.emplace_back(i, j); });
+            }
+            std::swap(frontier, next);
+            if (!progress) break;
+        }
+
+        // depth-first traversal of the tasks
+        std::vector<std::vector<std::pair<int, int>>> found(frontier.size());
+#pragma omp parallel for schedule(dynamic)
+        for (int t=0; t<static_cast<int>(frontier.size()); t++) {
+            std::vector<std::pair<int, int>> stack = {frontier[t]};
+            while (!stack.empty()) {
+                auto [na, nb] = stack.back();
+                stack.pop_back();
+                expand(na, nb, [&found, t](int i, int j) { found[t].emplace_back(i, j); }, [&stack](int i, int j) { stack.emplace_back(i, j); });
+            }
+        }
+        for (auto &f : found)
+            pairs.insert(pairs.end(), f.begin(), f.end());
+    }
+
+    // all the pairs (i, j) of primitives of a and b whose boxes intersect
+    template<int n> void overlapping_pairs(const HBoxes<n> &a, const HBoxes<n> &b, std::vector<std::pair<int, int>> &pairs) {
+        overlapping_pairs(a, b, pairs, false);
+    }
+
+    // all the pairs (i, j), i<j, of primitives of h whose boxes intersect
+    template<int n> void overlapping_pairs(const HBoxes<n> &h, std::vector<std::pair<int, int>> &pairs) {
+        overlapping_pairs(h, h, pairs, true);
+    }
+
     typedef HBoxes<1> HBoxes1;
     typedef HBoxes<2> HBoxes2;
     typedef HBoxes<3> HBoxes3;
@@ -2,6 +2,7 @@
 #define __HILBERT_SORT_H__
 
 #include <vector>
+#include <random>
 #include <cassert>
 #include <algorithm>
 #include "ultimaille/algebra/vec.h"
@@ -13,6 +14,8 @@ namespace UM {
     //   |_||_|_|_|_.__/\___|_|  \__| |___/\___/_|  \__|
     //
     struct HilbertSort {
+        static constexpr int PARALLEL_CUTOFF = 1<<14; // smaller ranges are sorted by a single task
+
         HilbertSort(const std::vector<vec3> &data) : pts(data) {}
 
         void apply(std::vector<int>& ind) const {
@@ -22,9 +25,39 @@ namespace UM {
         void apply(std::vector<int>& ind, int begin, int end) const {
             assert(begin >= 0 && begin <= (int)ind.size());
             assert(end   >= 0 && end   <= (int)ind.size());
+#if defined(_OPENMP) && _OPENMP>=200805
+#pragma omp parallel if (end - begin > PARALLEL_CUTOFF)
+#pragma omp single nowait
+#endif
             hilbert_sort<0, false, false, false>(ind.begin() + begin, ind.begin() + end);
         }
 
+        // Biased randomized insertion order (Amenta, Choi and Rote, Incremental constructions con BRIO, 2003):
+        // the indices are shuffled and split into rounds of doubling sizes (the last round holds about half of them),
+        // each round is Hilbert sorted (the rounds are sorted by concurrent tasks). Incremental algorithms (Delaunay, DynamicKNN...)
+        // get the locality of the space filling curve while the random rounds keep the expected complexity of a random insertion order.
+        // Returns the bounds of the rounds: round r is ind[bounds[r]..bounds[r+1]).
+        std::vector<int> brio(std::vector<int>& ind, const unsigned int seed = 0, const int first_round = 64) const {
+            std::mt19937 rng(seed);
+            std::shuffle(ind.begin(), ind.end(), rng);
+            std::vector<int> bounds = {static_cast<int>(ind.size())};
+            while (bounds.back() > first_round)
+                bounds.push_back(bounds.back()/2);
+            bounds.push_back(0);
+            std::reverse(bounds.begin(), bounds.end());
+#if defined(_OPENMP) && _OPENMP>=200805
+#pragma omp parallel if (ind.size() > PARALLEL_CUTOFF)
+#pragma omp single nowait
+#endif
+            for (int r=0; r+1<static_cast<int>(bounds.size()); r++) {
+#if defined(_OPENMP) && _OPENMP>=200805
+#pragma omp task
+#endif
+                hilbert_sort<0, false, false, false>(ind.begin() + bounds[r], ind.begin() + bounds[r+1]);
+            }
+            return bounds;
+        }
+
         // defines 6 order relations on vec3 (3 axis * 2 directions)
         template <int AX, bool DIR>
             struct CmpHilbert {
@@ -65,14 +98,28 @@ namespace UM {
                 std::vector<int>::iterator m5 = hilbert_split(m4, m6, CmpHilbert<z,  upz>(pts));
                 std::vector<int>::iterator m7 = hilbert_split(m6, m8, CmpHilbert<z, !upz>(pts));
 
-                hilbert_sort<z,  upz,  upx,  upy>(m0, m1);
-                hilbert_sort<y,  upy,  upz,  upx>(m1, m2);
-                hilbert_sort<y,  upy,  upz,  upx>(m2, m3);
-                hilbert_sort<x,  upx, !upy, !upz>(m3, m4);
-                hilbert_sort<x,  upx, !upy, !upz>(m4, m5);
-                hilbert_sort<y, !upy,  upz, !upx>(m5, m6);
-                hilbert_sort<y, !upy,  upz, !upx>(m6, m7);
-                hilbert_sort<z, !upz, !upx,  upy>(m7, m8);
+                const bool parallel = end - begin > PARALLEL_CUTOFF;
+                recurse<z,  upz,  upx,  upy>(m0, m1, parallel);
+                recurse<y,  upy,  upz,  upx>(m1, m2, parallel);
+                recurse<y,  upy,  upz,  upx>(m2, m3, parallel);
+                recurse<x,  upx, !upy, !upz>(m3, m4, parallel);
+                recurse<x,  upx, !upy, !upz>(m4, m5, parallel);
+                recurse<y, !upy,  upz, !upx>(m5, m6, parallel);
+                recurse<y, !upy,  upz, !upx>(m6, m7, parallel);
+                recurse<z, !upz, !upx,  upy>(m7, m8, parallel);
+            }
+
+        // the subranges are independent, they are sorted by OpenMP tasks when called from a parallel region
+        template <int x, bool upx, bool upy, bool upz>
+            void recurse(std::vector<int>::iterator begin, std::vector<int>::iterator end, const bool parallel) const {
+                if (!parallel) {
+                    hilbert_sort<x, upx, upy, upz>(begin, end);
+                    return;
+                }
+#if defined(_OPENMP) && _OPENMP>=200805
+#pragma omp task
+#endif
+                hilbert_sort<x, upx, upy, upz>(begin, end);
             }
 
         const std::vector<vec3> &pts;
@@ -6,25 +6,43 @@
 #include <numeric>
 #include <queue>
 #include <vector>
+#include <limits>
 #include "ultimaille/algebra/vec.h"
+#include "ultimaille/helpers/hilbert_sort.h"
+#include "ultimaille/memory_footprint.h"
+#include "ultimaille/syntactic-sugar/assert.h"
 
 namespace UM {
-    template<int D> struct KNN { // do not try anything but D=2 or D=3
-        const std::vector<vec<D>> &pts;
+    // Points can be any random access container returning vec<D> (by value or by reference), e.g. CompactPointSet
+    // leaf_size > 1 stops the subdivision at buckets of up to leaf_size points, whose coordinates are copied
+    // in structure-of-arrays order and scanned with vectorized distance computations (faster queries, D*n more doubles)
+    template<int D, typename Points = std::vector<vec<D>>> struct KNN { // do not try anything but D=2 or D=3
+        static constexpr int MAX_LEAF_SIZE = 64;
+
+        const Points &pts;
         const int n;
+        const int leaf_size;
         std::vector<int> tree;
+        std::vector<double> soa = {}; // bucketed trees only: soa[d*n+i] is the coordinate d of pts[tree[i]]
 
-        KNN(const std::vector<vec<D>> &points): pts(points), n(points.size()), tree(points.size()) {
+        KNN(const Points &points, const int leaf_size = 1): pts(points), n(points.size()), leaf_size(leaf_size), tree(points.size()) {
+            um_assert(leaf_size>=1 && leaf_size<=MAX_LEAF_SIZE);
             std::iota(tree.begin(), tree.end(), 0);
 #if defined(_OPENMP) && _OPENMP>=200805
 #pragma omp parallel
 #pragma omp single nowait
 #endif
             build(0, n);
+            if (leaf_size==1) return;
+            soa.resize(static_cast<size_t>(D)*n);
+#pragma omp parallel for
+            for (int i=0; i<n; i++)
+                for (int d=0; d<D; d++)
+                    soa[static_cast<size_t>(d)*n+i] = pts[tree[i]][d];
         }
 
         void build(const int L, const int R, const int dim=0) { // build is O(n log n) using divide and conquer
-            if (L >= R) return;
+            if (R-L <= leaf_size) return;
             int M = (L+R)/2; // get median in O(n), split dim coordinate
             std::nth_element(tree.begin()+L, tree.begin()+M, tree.begin()+R, [this, dim](int a, int b) { return pts[a][dim]<pts[b][dim]; });
 #if defined(_OPENMP) && _OPENMP>=200805
@@ -37,38 +55,203 @@ namespace UM {
             build(M+1, R, (dim+1)%D);
         }
 
+        MemoryFootprint memory_footprint() const { // the points are not owned by the tree
+            MemoryFootprint mf;
+            mf.add("tree", tree);
+            mf.add("coordinates", soa);
+            return mf;
+        }
+
+        // bounded max-heap of the k nearest candidates found so far, the buffer is reused across queries
+        // approximate mode: subtrees that cannot hold a point (1+eps) times closer than the current k-th neighbor are pruned,
+        // and once the heap is full, the search stops opening subtrees after max_checks candidates were examined
+        struct Neighborhood {
+            void reset(const int k, const double eps = 0., const int max_checks = std::numeric_limits<int>::max()) {
+                this->k = k;
+                shrink = 1./((1.+eps)*(1.+eps));
+                checks = max_checks;
+                heap.clear();
+                heap.reserve(k);
+            }
+
+            double bound() const { // squared distance to beat for a subtree to be explored
+                if (static_cast<int>(heap.size()) < k) return std::numeric_limits<double>::max(); // the budget never leaves the heap partially filled
+                if (checks <= 0) return -1.; // budget exhausted
+                return heap.front().first*shrink;
+            }
+
+            void insert(const double dist2, const int i) {
+                checks--;
+                if (static_cast<int>(heap.size()) < k) {
+                    heap.emplace_back(dist2, i);
+                    std::push_heap(heap.begin(), heap.end());
+                } else if (dist2 < heap.front().first) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = {dist2, i};
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+
+            int k = 0;
+            double shrink = 1.; // 1/(1+eps)^2
+            int checks = std::numeric_limits<int>::max();
+            std::vector<std::pair<double, int> > heap = {}; // (squared distance, point id)
+        };
+
         // k-nearest neighbor query, O(k log(k) log(n)) on average
         std::vector<int> query(const vec<D> &p, const int k = 1) const {
-            std::priority_queue<std::pair<double, int> > pq; // priority queue for KNN, keep the K nearest
+            Neighborhood nbh;
+            search(nbh, p, k);
+            std::vector<int> neighbors(nbh.heap.size());
+            for (int i=0; i<static_cast<int>(nbh.heap.size()); i++)
+                neighbors[i] = nbh.heap[i].second;
+            return neighbors;
+        }
 
-            perform_query(pq, p, k, 0, n, false); // recursion
-            std::vector<int> neighbors;
-            while (!pq.empty()) { // collect points
-                neighbors.push_back(pq.top().second);
-                pq.pop();
+        // approximate k-nearest neighbors: the i-th neighbor is at most (1+eps) times farther than the exact i-th neighbor,
+        // at most max_leaves leaves are visited (max_leaves points for leaf_size=1) once k candidates were found,
+        // the error bound is lost when the budget is exhausted; min(k, n) neighbors are always returned
+        std::vector<int> query_approx(const vec<D> &p, const int k, const double eps, const int max_leaves = std::numeric_limits<int>::max()) const {
+            Neighborhood nbh;
+            search(nbh, p, k, eps, max_leaves);
+            std::vector<int> neighbors(nbh.heap.size());
+            for (int i=0; i<static_cast<int>(nbh.heap.size()); i++)
+                neighbors[i] = nbh.heap[i].second;
+            return neighbors;
+        }
+
+        // k-nearest neighbors of a batch of queries, without allocation per query
+        // the neighbors of queries[q] sorted by distance are stored in out[q*kk..(q+1)*kk-1], where kk=min(k, n),
+        // and their squared distances in (*dist2)[q*kk..(q+1)*kk-1] if dist2 is not null
+        // hilbert_order: process the queries along a Hilbert curve for coherent tree traversals (D=3 only)
+        // eps, max_leaves: approximate queries, see query_approx()
+        void query_batch(const std::vector<vec<D> > &queries, const int k, std::vector<int> &out, std::vector<double> *dist2 = nullptr, const bool hilbert_order = false,
+                         const double eps = 0., const int max_leaves = std::numeric_limits<int>::max()) const {
+            const int nq = queries.size();
+            const int kk = std::min(k, n);
+            out.resize(static_cast<size_t>(nq)*kk);
+            if (dist2) dist2->resize(static_cast<size_t>(nq)*kk);
+
+            std::vector<int> order;
+            if constexpr (D==3) if (hilbert_order) {
+                order.resize(nq);
+                std::iota(order.begin(), order.end(), 0);
+                HilbertSort(queries).apply(order);
             }
-            std::reverse(neighbors.begin(), neighbors.end());
+
+#pragma omp parallel
+            {
+                Neighborhood nbh; // one per thread
+#pragma omp for schedule(dynamic, 256)
+                for (int i=0; i<nq; i++) {
+                    int q = order.empty() ? i : order[i];
+                    search(nbh, queries[q], kk, eps, max_leaves);
+                    for (int j=0; j<kk; j++) {
+                        out[static_cast<size_t>(q)*kk+j] = nbh.heap[j].second;
+                        if (dist2) (*dist2)[static_cast<size_t>(q)*kk+j] = nbh.heap[j].first;
+                    }
+                }
+            }
+        }
+
+        // all the points at distance <= r from p, in no particular order
+        std::vector<int> radius_query(const vec<D> &p, const double r) const {
+            std::vector<int> neighbors;
+            radius_search(p, r*r, neighbors);
             return neighbors;
         }
 
-        void perform_query(std::priority_queue<std::pair<double, int> > &pq, const vec<D> &p, const int k, const int L, const int R, const int dim) const {
+        // fixed-radius query of a batch of points, the result is in compressed row storage:
+        // the neighbors of queries[q] are neighbors[offset[q]..offset[q+1]-1]
+        void radius_query_batch(const std::vector<vec<D> > &queries, const double r, std::vector<int> &offset, std::vector<int> &neighbors) const {
+            constexpr int block = 1024;
+            const int nq = queries.size();
+            const int nblocks = (nq+block-1)/block;
+            std::vector<std::vector<int> > found(nblocks); // one buffer per block of queries
+            offset.assign(nq+1, 0);
+#pragma omp parallel for schedule(dynamic)
+            for (int b=0; b<nblocks; b++)
+                for (int q=b*block; q<std::min(nq, (b+1)*block); q++) {
+                    int before = found[b].size();
+                    radius_search(queries[q], r*r, found[b]);
+                    offset[q+1] = found[b].size() - before;
+                }
+
+            std::vector<int> block_offset(nblocks+1, 0);
+            for (int b=0; b<nblocks; b++)
+                block_offset[b+1] = block_offset[b] + found[b].size();
+            for (int q=0; q<nq; q++)
+                offset[q+1] += offset[q];
+            neighbors.resize(block_offset.back());
+#pragma omp parallel for
+            for (int b=0; b<nblocks; b++)
+                std::copy(found[b].begin(), found[b].end(), neighbors.begin() + block_offset[b]);
+        }
+
+        // appends to out all the points at squared distance <= r2 from p
+        void radius_search(const vec<D> &p, const double r2, std::vector<int> &out) const {
+            radius_search(p, r2, out, 0, n, 0);
+        }
+
+        void radius_search(const vec<D> &p, const double r2, std::vector<int> &out, const int L, const int R, const int dim) const {
             if (L >= R) return;
+            if (leaf_size>1 && R-L <= leaf_size) {
+                double dist2[MAX_LEAF_SIZE];
+                leaf_distances(p, L, R, dist2);
+                for (int i=L; i<R; i++)
+                    if (dist2[i-L] <= r2) out.push_back(tree[i]);
+                return;
+            }
             int M = (L+R)/2;
             vec<D> d = p - pts[tree[M]];
-            if (static_cast<int>(pq.size()) < k || d*d < pq.top().first) { // if point is nearer to the kth farthest, put point in queue
-                pq.push(std::make_pair(d*d, tree[M]));
-                if (static_cast<int>(pq.size()) > k) pq.pop(); // keep k elements only
+            if (d*d <= r2) out.push_back(tree[M]);
+            if (d[dim] <= 0 || d[dim]*d[dim] <= r2) // the ball intersects the left child
+                radius_search(p, r2, out, L, M, (dim+1)%D);
+            if (d[dim] >= 0 || d[dim]*d[dim] <= r2) // the ball intersects the right child
+                radius_search(p, r2, out, M+1, R, (dim+1)%D);
+        }
+
+        // fills nbh with the k nearest neighbors of p sorted by increasing distance
+        void search(Neighborhood &nbh, const vec<D> &p, const int k, const double eps = 0., const int max_leaves = std::numeric_limits<int>::max()) const {
+            nbh.reset(k, eps, static_cast<int>(std::min<long long>(std::numeric_limits<int>::max(), static_cast<long long>(max_leaves)*leaf_size)));
+            if (k>0) search(nbh, p, 0, n, 0);
+            std::sort_heap(nbh.heap.begin(), nbh.heap.end());
+        }
+
+        // Nbh is Neighborhood or any type providing insert(dist2, point id) and bound(), e.g. to filter the candidates
+        template <class Nbh> void search(Nbh &nbh, const vec<D> &p, const int L, const int R, const int dim) const {
+            if (L >= R) return;
+            if (leaf_size>1 && R-L <= leaf_size) {
+                double dist2[MAX_LEAF_SIZE];
+                leaf_distances(p, L, R, dist2);
+                for (int i=L; i<R; i++)
+                    nbh.insert(dist2[i-L], tree[i]);
+                return;
             }
+            int M = (L+R)/2;
+            vec<D> d = p - pts[tree[M]];
+            nbh.insert(d*d, tree[M]);
             int nearL = L, nearR = M, farL = M + 1, farR = R;
             if (d[dim] > 0) { // right is nearer
                 std::swap(nearL, farL);
                 std::swap(nearR, farR);
             }
-            // query the nearer child
-            perform_query(pq, p, k, nearL, nearR, (dim+1)%D);
+            search(nbh, p, nearL, nearR, (dim+1)%D);       // query the nearer child
+            if (d[dim]*d[dim] < nbh.bound())                // query the farther child if there might be candidates
+                search(nbh, p, farL, farR, (dim+1)%D);
+        }
 
-            if (static_cast<int>(pq.size()) < k || d[dim]*d[dim] < pq.top().first) // query the farther child if there might be candidates
-                perform_query(pq, p, k, farL, farR, (dim+1)%D);
+        // squared distances from p to the points of the bucket [L, R)
+        void leaf_distances(const vec<D> &p, const int L, const int R, double *dist2) const {
+            const int m = R-L;
+            for (int i=0; i<m; i++) dist2[i] = 0;
+            for (int d=0; d<D; d++) {
+                const double *c = soa.data() + static_cast<size_t>(d)*n + L;
+                const double pd = p[d];
+#pragma omp simd
+                for (int i=0; i<m; i++)
+                    dist2[i] += (c[i]-pd)*(c[i]-pd);
+            }
         }
     };
 }
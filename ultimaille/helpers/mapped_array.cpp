@@ -0,0 +1,94 @@
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+#include "ultimaille/helpers/mapped_array.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace UM {
+    MappedFile::MappedFile(const std::string &path, ACCESS access) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                access==SEQUENTIAL ? FILE_FLAG_SEQUENTIAL_SCAN : (access==RANDOM ? FILE_FLAG_RANDOM_ACCESS : FILE_ATTRIBUTE_NORMAL), nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            file = nullptr;
+            throw std::runtime_error("Failed to open " + path);
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(file, &size);
+        bytes = static_cast<size_t>(size.QuadPart);
+        if (!bytes) return;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!addr) {
+            unmap();
+            throw std::runtime_error("Failed to map " + path);
+        }
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Failed to open " + path);
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            close(fd);
+            throw std::runtime_error("Failed to stat " + path);
+        }
+        bytes = static_cast<size_t>(st.st_size);
+        if (!bytes) {
+            close(fd);
+            return;
+        }
+        void *ptr = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd); // the mapping keeps a reference to the file
+        if (ptr == MAP_FAILED) {
+            bytes = 0;
+            throw std::runtime_error("Failed to map " + path);
+        }
+        if (access != NORMAL)
+            madvise(ptr, bytes, access==SEQUENTIAL ? MADV_SEQUENTIAL : MADV_RANDOM);
+        addr = ptr;
+#endif
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile &&other) noexcept {
+        if (this == &other) return *this;
+        unmap();
+        std::swap(addr,  other.addr);
+        std::swap(bytes, other.bytes);
+#ifdef _WIN32
+        std::swap(file,    other.file);
+        std::swap(mapping, other.mapping);
+#endif
+        return *this;
+    }
+
+    void MappedFile::unmap() {
+#ifdef _WIN32
+        if (addr)    UnmapViewOfFile(addr);
+        if (mapping) CloseHandle(mapping);
+        if (file)    CloseHandle(file);
+        mapping = file = nullptr;
+#else
+        if (addr) munmap(const_cast<void *>(addr), bytes);
+#endif
+        addr = nullptr;
+        bytes = 0;
+    }
+
+    void write_mapped_array(const std::string &path, const void *data, size_t bytes) {
+        std::ofstream out(path, std::ios::binary);
+        if (out.fail())
+            throw std::runtime_error("Failed to open " + path);
+        out.write(static_cast<const char *>(data), bytes);
+        if (out.fail())
+            throw std::runtime_error("Failed to write " + path);
+    }
+}
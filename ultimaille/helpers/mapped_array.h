@@ -0,0 +1,70 @@
+#ifndef __MAPPED_ARRAY_H__
+#define __MAPPED_ARRAY_H__
+
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace UM {
+    // Read-only memory mapping of a whole file, the OS pages the data in on demand.
+    struct MappedFile {
+        enum ACCESS { NORMAL=0, SEQUENTIAL=1, RANDOM=2 }; // paging hint
+
+        MappedFile() = default;
+        MappedFile(const std::string &path, ACCESS access = NORMAL);
+        MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+        MappedFile& operator=(MappedFile &&other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile() { unmap(); }
+
+        void unmap();
+        const void *data() const { return addr; }
+        size_t size() const { return bytes; }
+
+    protected:
+        const void *addr = nullptr;
+        size_t bytes = 0;
+#ifdef _WIN32
+        void *file = nullptr;
+        void *mapping = nullptr;
+#endif
+    };
+
+    // Array of trivially copyable elements stored in a raw binary file (no header, native endianness),
+    // e.g. the point coordinates, the facet or cell corner indices, or a numeric attribute of a mesh.
+    // It can replace std::vector in read-mostly kernels over datasets larger than the RAM: KNN<3, MappedArray<vec3> >, Meter<MappedArray<vec3> >...
+    template <typename T> struct MappedArray {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        MappedArray() = default;
+        MappedArray(const std::string &path, MappedFile::ACCESS access = MappedFile::NORMAL) : file(path, access) {
+            if (file.size() % sizeof(T))
+                throw std::runtime_error(path + " is not an array of " + std::to_string(sizeof(T)) + "-byte elements (truncated file?)");
+            if (file.size() / sizeof(T) > static_cast<size_t>(std::numeric_limits<int>::max()))
+                throw std::runtime_error(path + " holds more than INT_MAX elements");
+        }
+
+        int size() const { return static_cast<int>(file.size() / sizeof(T)); }
+        const T* data() const { return static_cast<const T*>(file.data()); }
+        const T& operator[](const int i) const { assert(i>=0 && i<size()); return data()[i]; }
+        const T* begin() const { return data(); }
+        const T* end()   const { return data() + size(); }
+
+        MappedFile file;
+    };
+
+    // write a raw binary file that can be mapped by MappedArray<T>
+    void write_mapped_array(const std::string &path, const void *data, size_t bytes);
+
+    template <typename T> void write_mapped_array(const std::string &path, const std::vector<T> &array) {
+        static_assert(std::is_trivially_copyable_v<T> && !std::is_same_v<T, bool>);
+        write_mapped_array(path, array.data(), sizeof(T)*array.size());
+    }
+}
+
+#endif //__MAPPED_ARRAY_H__
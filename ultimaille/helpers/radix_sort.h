@@ -0,0 +1,56 @@
+#ifndef __RADIX_SORT_H__
+#define __RADIX_SORT_H__
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include "ultimaille/syntactic-sugar/assert.h"
+
+namespace UM {
+    // Stable LSD radix sort of the values by their 64-bit keys, both arrays are permuted.
+    // 8 bits per pass, the passes over a digit shared by all the keys are skipped (e.g. the high bits of small keys).
+    // The input is cut into blocks whose histograms and scatters are processed in parallel.
+    inline void radix_sort(std::vector<uint64_t> &keys, std::vector<int> &values) {
+        um_assert(keys.size() == values.size());
+        constexpr int block = 1<<16;
+        const int n = keys.size();
+        const int nblocks = (n+block-1)/block;
+        std::vector<uint64_t> keys_tmp(n);
+        std::vector<int> values_tmp(n);
+        std::vector<int> count(nblocks*256);
+        for (int shift=0; shift<64; shift+=8) {
+            std::fill(count.begin(), count.end(), 0);
+#pragma omp parallel for if (nblocks > 1)
+            for (int b=0; b<nblocks; b++)
+                for (int i=b*block; i<std::min(n, (b+1)*block); i++)
+                    count[b*256 + ((keys[i]>>shift) & 255)]++;
+
+            bool constant = false; // exclusive prefix sum in (digit, block) order: the start of each block in each bucket
+            for (int d=0, sum=0; d<256; d++) {
+                int total = 0;
+                for (int b=0; b<nblocks; b++) {
+                    int c = count[b*256 + d];
+                    count[b*256 + d] = sum;
+                    sum += c;
+                    total += c;
+                }
+                constant = constant || total==n;
+            }
+            if (constant) continue;
+
+#pragma omp parallel for if (nblocks > 1)
+            for (int b=0; b<nblocks; b++)
+                for (int i=b*block; i<std::min(n, (b+1)*block); i++) {
+                    int &pos = count[b*256 + ((keys[i]>>shift) & 255)];
+                    keys_tmp[pos] = keys[i];
+                    values_tmp[pos] = values[i];
+                    pos++;
+                }
+            std::swap(keys, keys_tmp);
+            std::swap(values, values_tmp);
+        }
+    }
+}
+
+#endif //__RADIX_SORT_H__
@@ -0,0 +1,402 @@
+#include <cassert>
+#include <limits>
+#include <algorithm>
+#include "ultimaille/syntactic-sugar/range.h"
+#include "ultimaille/helpers/bvh.h"
+#include "ultimaille/helpers/voronoi.h"
+
+namespace UM {
+    ConvexCell::ConvexCell(const vec2 min, const vec2 max) {
+        status = success;
+
+        clip[0] = vec3( 1.0,  0.0, -min.x);
+        clip[1] = vec3( 0.0,  1.0, -min.y);
+        clip[2] = vec3(-1.0,  0.0,  max.x);
+        clip[3] = vec3( 0.0, -1.0,  max.y);
+        nb_v = 4;
+
+        tr[0] = 1;
+        tr[1] = 2;
+        tr[2] = 3;
+        tr[3] = 0;
+        nb_t = 4;
+
+        for (int t : range(4))
+            vpos[t] = vertex(t);
+
+        head = 0;
+    }
+
+    void ConvexCell::clip_by_line(const vec3 eqn) {
+        if (status!=success) return;
+
+        int beg = -1; // find the portion of the polygon to cut
+        int end = -1;
+        int cur = head;
+        do {
+            bool a = vpos[   cur ]*eqn<0;
+            bool b = vpos[tr[cur]]*eqn<0;
+            if (a) nb_t--;
+
+            if (!a &&  b && beg!=-1) {
+                status = inconsistent_boundary;
+                return;
+            }
+
+            if (!a &&  b) beg = cur;
+            if ( a && !b) end = cur;
+            cur = tr[cur];
+        } while (cur!=head);
+
+        if (nb_t<1) {
+            status = empty_cell;
+            return;
+        }
+
+        assert((beg<0 && end<0) || (beg>=0 && end>=0));
+        if (beg<0) return;
+
+        if (nb_v >= _MAX_P_) {
+            status = vertex_overflow;
+            return;
+        }
+
+        tr[nb_v] = tr[end]; // update the linked list
+        head = tr[tr[beg]] = nb_v;
+        clip[nb_v++] = eqn;
+
+        nb_t += 2; // compute 2 new vertices
+        vpos[head]    = vertex(head);
+        vpos[tr[beg]] = vertex(tr[beg]);
+    }
+
+    vec3 ConvexCell::vertex(const int t) const {
+        return cross(clip[t], clip[tr[t]]);
+    }
+
+    void ConvexCell::export_verts(std::vector<vec2> &verts) const {
+        verts = std::vector<vec2>(nb_t);
+        int cur = head;
+        int cnt = 0;
+        do {
+            const vec3 &p = vpos[cur];
+            verts[cnt++] = {p.x/p.z, p.y/p.z};
+            cur = tr[cur];
+        } while (cur!=head);
+    }
+
+    double ConvexCell::squared_radius(const vec2 &c) const {
+        double r2 = 0;
+        int cur = head;
+        do {
+            const vec3 &p = vpos[cur];
+            r2 = std::max(r2, (vec2{p.x/p.z, p.y/p.z} - c).norm2());
+            cur = tr[cur];
+        } while (cur!=head);
+        return r2;
+    }
+
+    void ConvexCell::area_centroid(double &area, vec2 &centroid) const {
+        area = 0;
+        centroid = {0, 0};
+        const vec2 o = {vpos[head].x/vpos[head].z, vpos[head].y/vpos[head].z};
+        for (int cur = tr[head]; tr[cur]!=head; cur = tr[cur]) { // fan triangulation around o
+            const vec3 &p = vpos[cur], &q = vpos[tr[cur]];
+            vec2 a = vec2{p.x/p.z, p.y/p.z} - o;
+            vec2 b = vec2{q.x/q.z, q.y/q.z} - o;
+            double tri = (a.x*b.y - a.y*b.x)/2.;
+            area += tri;
+            centroid += tri*(a+b)/3.;
+        }
+        centroid = area>0 ? o + centroid/area : o;
+    }
+
+    void ConvexCell3::init(const BBox3 &box) {
+        pts.resize(8);
+        for (int i=0; i<8; i++) // vertex i is at the corner (i&1, i&2, i&4) of the box
+            pts[i] = {i&1 ? box.max.x : box.min.x, i&2 ? box.max.y : box.min.y, i&4 ? box.max.z : box.min.z};
+        verts = { 0,4,6,2,  1,3,7,5,  0,1,5,4,  2,6,7,3,  0,2,3,1,  4,5,7,6 };
+        offset = { 0, 4, 8, 12, 16, 20, 24 };
+    }
+
+    void ConvexCell3::clip_by_plane(const vec4 &eqn) {
+        const int nv = pts.size();
+        side.resize(nv);
+        bool cut = false, kept = false;
+        for (int v=0; v<nv; v++) {
+            side[v] = eqn[0]*pts[v].x + eqn[1]*pts[v].y + eqn[2]*pts[v].z + eqn[3];
+            cut  = cut  || side[v] <  0;
+            kept = kept || side[v] >= 0;
+        }
+        if (!cut) return;
+        if (!kept) {
+            pts.clear();
+            verts.clear();
+            offset = {0};
+            return;
+        }
+
+        new_pts.clear();
+        remap.resize(nv);
+        for (int v=0; v<nv; v++) {
+            remap[v] = -1;
+            if (side[v] < 0) continue;
+            remap[v] = new_pts.size();
+            new_pts.push_back(pts[v]);
+        }
+
+        cut_edges.clear();
+        auto cut_vertex = [&](int a, int b) { // the intersection of the edge ab with the plane, shared by both faces of the edge
+            if (a > b) std::swap(a, b);
+            if (side[a]==0) return remap[a]; // N.B. b is outside
+            if (side[b]==0) return remap[b];
+            const int key = a*nv + b;
+            for (const auto &[k, v] : cut_edges)
+                if (k==key) return v;
+            double t = side[a]/(side[a] - side[b]);
+            cut_edges.emplace_back(key, new_pts.size());
+            new_pts.push_back(pts[a] + (pts[b]-pts[a])*t);
+            return static_cast<int>(new_pts.size()) - 1;
+        };
+
+        new_offset = {0};
+        new_verts.clear();
+        cap_links.clear();
+        for (int f=0; f<nfaces(); f++) {
+            const int size = offset[f+1] - offset[f];
+            face_cuts.clear();
+            auto push = [&](int v) { // vertices lying on the plane are not duplicated
+                if (static_cast<int>(new_verts.size()) > new_offset.back() && new_verts.back()==v) return;
+                new_verts.push_back(v);
+            };
+            for (int j=0; j<size; j++) {
+                const int a = verts[offset[f] + j], b = verts[offset[f] + (j+1)%size];
+                if (side[a] >= 0) push(remap[a]);
+                if ((side[a] >= 0) == (side[b] >= 0)) continue;
+                const int x = cut_vertex(a, b);
+                push(x);
+                face_cuts.push_back(side[a] >= 0 ? -1-x : x); // negative: the face leaves the half-space at x
+            }
+            const int ncuts = face_cuts.size(); // the face goes along the cap from each exit point to the next entry point
+            for (int q=0; q<ncuts; q++)
+                if (face_cuts[q] < 0 && face_cuts[(q+1)%ncuts] != -1-face_cuts[q])
+                    cap_links.emplace_back(face_cuts[(q+1)%ncuts], -1-face_cuts[q]);
+            if (static_cast<int>(new_verts.size()) - new_offset.back() > 1 && new_verts.back()==new_verts[new_offset.back()])
+                new_verts.pop_back();
+            if (static_cast<int>(new_verts.size()) - new_offset.back() >= 3)
+                new_offset.push_back(new_verts.size());
+            else
+                new_verts.resize(new_offset.back());
+        }
+
+        // the cap is traversed in the opposite direction: from the entry point to the exit point of each face
+        cap_next.assign(new_pts.size(), -1);
+        for (const auto &[from, to] : cap_links)
+            cap_next[from] = to;
+        for (const auto &[from, to] : cap_links) {
+            if (cap_next[from] < 0) continue; // already emitted
+            int cur = from;
+            while (cur >= 0 && cap_next[cur] >= 0) {
+                new_verts.push_back(cur);
+                int next = cap_next[cur];
+                cap_next[cur] = -1;
+                cur = next;
+            }
+            if (static_cast<int>(new_verts.size()) - new_offset.back() >= 3)
+                new_offset.push_back(new_verts.size());
+            else
+                new_verts.resize(new_offset.back());
+        }
+
+        std::swap(pts, new_pts);
+        std::swap(offset, new_offset);
+        std::swap(verts, new_verts);
+    }
+
+    double ConvexCell3::squared_radius(const vec3 &c) const {
+        double r2 = 0;
+        for (const vec3 &p : pts)
+            r2 = std::max(r2, (p-c).norm2());
+        return r2;
+    }
+
+    void ConvexCell3::volume_centroid(double &volume, vec3 &centroid) const {
+        volume = 0;
+        centroid = {0, 0, 0};
+        if (empty()) return;
+        const vec3 o = pts[verts[0]];
+        for (int f=0; f<nfaces(); f++) { // fan triangulation of the faces, coned to o
+            const vec3 a = pts[verts[offset[f]]] - o;
+            for (int j=offset[f]+1; j+1<offset[f+1]; j++) {
+                const vec3 b = pts[verts[j]] - o, c = pts[verts[j+1]] - o;
+                double tet = a*cross(b, c)/6.;
+                volume += tet;
+                centroid += tet*(a+b+c)/4.;
+            }
+        }
+        centroid = volume>0 ? o + centroid/volume : o;
+    }
+
+    // index of the first neighbor not closer than dist2, the neighbors are sorted by increasing distance
+    static int first_unclipped(const std::vector<std::pair<double, int> > &heap, const double dist2) {
+        return std::partition_point(heap.begin(), heap.end(), [dist2](const std::pair<double, int> &e) { return e.first < dist2; }) - heap.begin();
+    }
+
+    bool voronoi_cell(const KNN<2> &knn, KNN<2>::Neighborhood &nbh, ConvexCell &cc, const std::vector<vec2> &pts, const int seed, const int k) {
+        const int n = pts.size();
+        const vec2 &x = pts[seed];
+        double done = -1; // the neighbors closer than done are already clipped, the clipping order does not matter
+        for (int kk = std::min(k, n); ; kk = std::min(2*kk, n)) {
+            knn.search(nbh, x, kk);
+            // N.B. the neighbors at distance done may differ from one search to the next (ties),
+            // they are clipped unless their line is already in cc.clip[] (clipping twice by a line degenerates the cell)
+            for (int i=first_unclipped(nbh.heap, done); i<kk; i++) { // clip by half-planes
+                const int j = nbh.heap[i].second;
+                if (j==seed) continue;
+                vec2 dir = x - pts[j];
+                vec3 line = vec3(dir.x, dir.y, -((x+pts[j])*dir)/2.);
+                if (nbh.heap[i].first==done && std::find_if(cc.clip, cc.clip+cc.nb_v, [&line](const vec3 &l) { return (l-line).norm2()==0; })!=cc.clip+cc.nb_v)
+                    continue;
+                cc.clip_by_line(line);
+            }
+            done = nbh.heap.back().first;
+            if (cc.status!=ConvexCell::success) return false;
+            if (kk==n || cc.squared_radius(x)*4 < nbh.heap.back().first)
+                return true;
+        }
+    }
+
+    bool voronoi_cell(const KNN<3> &knn, KNN<3>::Neighborhood &nbh, ConvexCell3 &cc, const std::vector<vec3> &pts, const int seed, const int k) {
+        const int n = pts.size();
+        const vec3 &x = pts[seed];
+        double done = -1;
+        cc.clipped.clear();
+        for (int kk = std::min(k, n); ; kk = std::min(2*kk, n)) {
+            knn.search(nbh, x, kk);
+            for (int i=first_unclipped(nbh.heap, done); i<kk && !cc.empty(); i++) {
+                const int j = nbh.heap[i].second;
+                if (j==seed) continue;
+                if (nbh.heap[i].first==done && std::find(cc.clipped.begin(), cc.clipped.end(), j)!=cc.clipped.end()) continue; // tie
+                vec3 dir = x - pts[j];
+                cc.clip_by_plane({dir.x, dir.y, dir.z, -((x+pts[j])*dir)/2.});
+                cc.clipped.push_back(j);
+            }
+            done = nbh.heap.back().first;
+            if (cc.empty()) return false;
+            if (kk==n || cc.squared_radius(x)*4 < nbh.heap.back().first)
+                return true;
+        }
+    }
+
+    // N.B. the seeds are processed in the order of the leaves of the k-d tree: consecutive queries visit the same branches
+    void voronoi_diagram(const std::vector<vec2> &seeds, const BBox2 &domain, Polygons &voronoi) {
+        constexpr int block = 1024;
+        const int n = seeds.size();
+        const int nblocks = (n+block-1)/block;
+        KNN<2> knn(seeds, 8);
+        std::vector<std::vector<vec2> > cells(nblocks); // the vertices of the cells, concatenated block by block
+        std::vector<int> size(n, 0), start(n, 0);
+#pragma omp parallel
+        {
+            KNN<2>::Neighborhood nbh;
+            std::vector<vec2> verts;
+#pragma omp for schedule(dynamic, 1)
+            for (int b=0; b<nblocks; b++)
+                for (int t=b*block; t<std::min(n, (b+1)*block); t++) {
+                    const int i = knn.tree[t];
+                    ConvexCell cc(domain.min, domain.max);
+                    if (!voronoi_cell(knn, nbh, cc, seeds, i)) continue;
+                    cc.export_verts(verts);
+                    size[i] = verts.size();
+                    start[i] = cells[b].size();
+                    cells[b].insert(cells[b].end(), verts.begin(), verts.end());
+                }
+        }
+
+        voronoi.clear();
+        int nverts = 0;
+        for (int i=0; i<n; i++) {
+            voronoi.create_facets(1, size[i]);
+            nverts += size[i];
+        }
+        voronoi.points.create_points(nverts);
+#pragma omp parallel for
+        for (int t=0; t<n; t++) {
+            const int i = knn.tree[t];
+            const std::vector<vec2> &verts = cells[t/block];
+            for (int j=0; j<size[i]; j++) {
+                voronoi.points[voronoi.offset[i] + j] = verts[start[i] + j].xy0();
+                voronoi.facets[voronoi.offset[i] + j] = voronoi.offset[i] + j;
+            }
+        }
+    }
+
+    void voronoi_centroids(const std::vector<vec2> &seeds, const BBox2 &domain, std::vector<vec2> &centroids, std::vector<double> &areas) {
+        const int n = seeds.size();
+        KNN<2> knn(seeds, 8);
+        centroids.resize(n);
+        areas.resize(n);
+#pragma omp parallel
+        {
+            KNN<2>::Neighborhood nbh;
+#pragma omp for schedule(dynamic, 256)
+            for (int t=0; t<n; t++) {
+                const int i = knn.tree[t];
+                ConvexCell cc(domain.min, domain.max);
+                if (voronoi_cell(knn, nbh, cc, seeds, i))
+                    cc.area_centroid(areas[i], centroids[i]);
+                else {
+                    areas[i] = 0;
+                    centroids[i] = seeds[i];
+                }
+            }
+        }
+    }
+
+    void restricted_voronoi_centroids(const std::vector<vec3> &seeds, const Tetrahedra &domain, std::vector<vec3> &centroids, std::vector<double> &volumes) {
+        const int n = seeds.size();
+        centroids.resize(n);
+        volumes.resize(n);
+        BBox3 box;
+        for (const vec3 &p : domain.points) box.add(p);
+        for (const vec3 &p : seeds) box.add(p);
+        KNN<3> knn(seeds);
+        BVHTetrahedra bvh(domain);
+#pragma omp parallel
+        {
+            KNN<3>::Neighborhood nbh;
+            ConvexCell3 cell, piece;
+            std::vector<int> tets;
+#pragma omp for schedule(dynamic, 64)
+            for (int t=0; t<n; t++) {
+                const int i = knn.tree[t];
+                volumes[i] = 0;
+                centroids[i] = seeds[i];
+                cell.init(box);
+                if (!voronoi_cell(knn, nbh, cell, seeds, i)) continue;
+                BBox3 cellbox;
+                for (const vec3 &p : cell.pts) cellbox.add(p);
+                bvh.intersect(cellbox, tets);
+                vec3 moment = {0, 0, 0};
+                for (int c : tets) {
+                    Tetrahedron tet = bvh.primitive(c);
+                    piece.pts = cell.pts;
+                    piece.offset = cell.offset;
+                    piece.verts = cell.verts;
+                    for (int lv=0; lv<4 && !piece.empty(); lv++) { // the face opposite to lv, oriented towards lv
+                        const vec3 &a = tet[(lv+1)%4], &b = tet[(lv+2)%4], &c = tet[(lv+3)%4];
+                        vec3 nrm = cross(b-a, c-a);
+                        if (nrm*(tet[lv]-a) < 0) nrm = -nrm;
+                        piece.clip_by_plane({nrm.x, nrm.y, nrm.z, -(nrm*a)});
+                    }
+                    double vol;
+                    vec3 g;
+                    piece.volume_centroid(vol, g);
+                    volumes[i] += vol;
+                    moment += vol*g;
+                }
+                if (volumes[i]>0) centroids[i] = moment/volumes[i];
+            }
+        }
+    }
+}
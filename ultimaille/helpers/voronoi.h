@@ -0,0 +1,96 @@
+#ifndef __VORONOI_H__
+#define __VORONOI_H__
+
+#include <vector>
+#include "ultimaille/algebra/vec.h"
+#include "ultimaille/helpers/knn.h"
+#include "ultimaille/helpers/hboxes.h"
+#include "ultimaille/surface.h"
+#include "ultimaille/volume.h"
+
+namespace UM {
+    // Convex polygon defined as an intersection of half-planes, vertices are stored in homogeneous coordinates.
+    // Fixed capacity and no allocation: meant to be used as a per-thread scratch buffer.
+    struct ConvexCell {
+        enum Status {
+            vertex_overflow = 1,
+            inconsistent_boundary = 2,
+            security_radius_not_reached = 3,
+            success = 4,
+            empty_cell = 6
+        };
+
+        ConvexCell(const vec2 min, const vec2 max);
+
+        void clip_by_line(const vec3 eqn); // keeps the half-plane eqn*(x, y, 1) >= 0
+        void export_verts(std::vector<vec2> &verts) const;
+        vec3 vertex(const int t) const;
+        double squared_radius(const vec2 &c) const; // max squared distance from c to the vertices
+        void area_centroid(double &area, vec2 &centroid) const;
+
+        // N.B. clip[], tr[] and head suffice to compute all; vpos[], nb_v and nb_t are here for performance reasons
+
+        static constexpr int _MAX_P_ = 256;
+        vec3 clip[_MAX_P_];  // clipping half-planes
+        int    tr[_MAX_P_];  // memory pool for chained lists of triangles
+        vec3 vpos[_MAX_P_];  // precomputed convex cell vertices (corresponds to tr[])
+
+        int head;
+        int nb_v; // number of clipping lines
+        int nb_t; // number of convex cell vertices
+
+        Status status;
+    };
+
+    // Convex polyhedron defined as an intersection of half-spaces, stored as a list of polygonal faces
+    // oriented counterclockwise seen from the outside. The buffers are reused by the successive clippings.
+    struct ConvexCell3 {
+        ConvexCell3() = default;
+        ConvexCell3(const BBox3 &box) { init(box); }
+
+        void init(const BBox3 &box);
+        void clip_by_plane(const vec4 &eqn); // keeps the half-space eqn*(x, y, z, 1) >= 0
+        bool empty() const { return offset.size() < 2; }
+        int nfaces() const { return static_cast<int>(offset.size()) - 1; }
+        double squared_radius(const vec3 &c) const; // max squared distance from c to the vertices
+        void volume_centroid(double &volume, vec3 &centroid) const;
+
+        std::vector<vec3> pts = {};
+        std::vector<int> offset = {0}; // the vertices of the face f are verts[offset[f]..offset[f+1]-1]
+        std::vector<int> verts = {};
+
+        // scratch
+        std::vector<double> side = {};
+        std::vector<int> remap = {};
+        std::vector<vec3> new_pts = {};
+        std::vector<int> new_offset = {};
+        std::vector<int> new_verts = {};
+        std::vector<std::pair<int, int> > cut_edges = {}; // (edge key, new vertex)
+        std::vector<int> face_cuts = {};
+        std::vector<std::pair<int, int> > cap_links = {};
+        std::vector<int> cap_next = {};
+        std::vector<int> clipped = {}; // the neighbors already clipped by voronoi_cell()
+    };
+
+    // Voronoi cell of pts[seed] restricted to the initial polygon of cc: cc is clipped by the bisectors of the k nearest neighbors,
+    // k is doubled until the security radius is reached (the next neighbor is farther than twice the farthest vertex of the cell).
+    // nbh is the k-NN query buffer, both cc and nbh can be reused from one cell to the next.
+    bool voronoi_cell(const KNN<2> &knn, KNN<2>::Neighborhood &nbh, ConvexCell &cc, const std::vector<vec2> &pts, const int seed, const int k = 16);
+
+    // same in 3D, cc must be initialized to a convex domain containing pts[seed]
+    bool voronoi_cell(const KNN<3> &knn, KNN<3>::Neighborhood &nbh, ConvexCell3 &cc, const std::vector<vec3> &pts, const int seed, const int k = 32);
+
+    // Voronoi diagram of the seeds clipped by the domain, the i-th facet is the cell of seeds[i] (empty if the seed is outside of the domain).
+    // The cells do not share their vertices, use colocate() to weld them. The cells are computed in parallel.
+    void voronoi_diagram(const std::vector<vec2> &seeds, const BBox2 &domain, Polygons &voronoi);
+
+    // area and centroid of each Voronoi cell clipped by the domain, a Lloyd iteration is seeds = centroids
+    // the centroid of an empty cell is its seed
+    void voronoi_centroids(const std::vector<vec2> &seeds, const BBox2 &domain, std::vector<vec2> &centroids, std::vector<double> &areas);
+
+    // volume and centroid of each Voronoi cell restricted to a tetrahedral mesh (not necessarily convex):
+    // each cell is intersected with the tetrahedra overlapping its bounding box
+    void restricted_voronoi_centroids(const std::vector<vec3> &seeds, const Tetrahedra &domain, std::vector<vec3> &centroids, std::vector<double> &volumes);
+}
+
+#endif // __VORONOI_H__
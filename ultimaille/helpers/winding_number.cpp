@@ -0,0 +1,85 @@
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <algorithm>
+#include "ultimaille/helpers/winding_number.h"
+
+namespace UM {
+    // signed solid angle of the triangle ABC seen from the origin (Van Oosterom and Strackee)
+    static double solid_angle(const vec3 &a, const vec3 &b, const vec3 &c) {
+        double la = a.norm(), lb = b.norm(), lc = c.norm();
+        double det = a*cross(b, c);
+        double div = la*lb*lc + (a*b)*lc + (b*c)*la + (c*a)*lb;
+        return 2.*std::atan2(det, div);
+    }
+
+    WindingNumber::WindingNumber(const BVHTriangles &bvh, const double beta) : bvh(bvh), beta(beta),
+            dipole(bvh.tree.size(), vec3(0, 0, 0)), center(bvh.tree.size(), vec3(0, 0, 0)), radius(bvh.tree.size(), 0.) {
+        if (bvh.tree.empty()) return;
+        std::vector<double> area(bvh.tree.size(), 0.);
+        const int nleaves = bvh.tree.size() - bvh.offset;
+#pragma omp parallel for
+        for (int b=0; b<nleaves; b++) {
+            const int node = bvh.offset + b;
+            Triangle3 tri = bvh.primitive(bvh.tree_pos_to_org[b]);
+            dipole[node] = .5*cross(tri[1]-tri[0], tri[2]-tri[0]);
+            area[node] = dipole[node].norm();
+            center[node] = tri.bary_verts();
+            for (int lv=0; lv<3; lv++)
+                radius[node] = std::max(radius[node], (tri[lv]-center[node]).norm());
+        }
+        for (int level=mylog2(bvh.offset+1); level--;) { // bottom-up, level by level
+            const int beg = (1<<level) - 1, end = (2<<level) - 1;
+#pragma omp parallel for if (end-beg > 1024)
+            for (int i=beg; i<end; i++) {
+                int sons[2], nsons = 0;
+                for (int son=2*i+1; son<2*i+3; son++)
+                    if (son < static_cast<int>(bvh.tree.size()) && !bvh.tree[son].empty())
+                        sons[nsons++] = son;
+                for (int k=0; k<nsons; k++) {
+                    dipole[i] += dipole[sons[k]];
+                    area[i]   += area[sons[k]];
+                    center[i] += area[sons[k]]*center[sons[k]];
+                }
+                if (area[i] > 0) center[i] = center[i]/area[i];
+                else if (!bvh.tree[i].empty()) center[i] = bvh.tree[i].center(); // degenerate facets only
+                for (int k=0; k<nsons; k++)
+                    radius[i] = std::max(radius[i], (center[sons[k]]-center[i]).norm() + radius[sons[k]]);
+            }
+        }
+    }
+
+    double WindingNumber::winding_number(const vec3 &p) const {
+        if (bvh.tree.empty()) return 0;
+        double omega = 0;
+        int stack[128]; // the tree depth is at most 33
+        int top = 0;
+        stack[top++] = 0;
+        while (top) {
+            int node = stack[--top];
+            if (bvh.tree[node].empty()) continue;
+            if (node >= bvh.offset) { // exact contribution of a facet
+                Triangle3 tri = bvh.primitive(bvh.tree_pos_to_org[node - bvh.offset]);
+                omega += solid_angle(tri[0]-p, tri[1]-p, tri[2]-p);
+                continue;
+            }
+            vec3 d = center[node] - p;
+            double dist = d.norm();
+            if (dist > beta*radius[node]) { // far field: dipole approximation
+                omega += (d*dipole[node])/(dist*dist*dist);
+                continue;
+            }
+            for (int son=2*node+1; son<2*node+3; son++)
+                if (son < static_cast<int>(bvh.tree.size()))
+                    stack[top++] = son;
+        }
+        return omega/(4.*M_PI);
+    }
+
+    void WindingNumber::winding_numbers(const std::vector<vec3> &pts, std::vector<double> &w) const {
+        const int npts = pts.size();
+        w.resize(npts);
+#pragma omp parallel for schedule(dynamic, 64)
+        for (int i=0; i<npts; i++)
+            w[i] = winding_number(pts[i]);
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef __WINDING_NUMBER_H__
+#define __WINDING_NUMBER_H__
+
+#include <vector>
+#include "ultimaille/algebra/vec.h"
+#include "ultimaille/helpers/bvh.h"
+
+namespace UM {
+    // Generalized winding number of a triangulated surface: the sum of the signed solid angles of its facets divided by 4pi.
+    // It is 1 inside and 0 outside a closed outward-oriented surface, and degrades smoothly on open, non-manifold
+    // or self-intersecting inputs, where inside(p) is a robust alternative to ray parity.
+    // Fast evaluation (Barill et al., Fast winding numbers for soups and clouds, 2018): each node of the BVH stores the dipole
+    // (sum of the area-weighted facet normals) of its facets, the nodes farther than beta times their radius are
+    // approximated by their dipole, the others are opened (Barnes-Hut). A larger beta is more accurate, beta=inf is exact.
+    // The expansions are computed at construction, the structure must be rebuilt if the mesh moves.
+    struct WindingNumber {
+        WindingNumber(const BVHTriangles &bvh, const double beta = 2.);
+
+        double winding_number(const vec3 &p) const;
+        void winding_numbers(const std::vector<vec3> &pts, std::vector<double> &w) const;
+        bool inside(const vec3 &p) const { return winding_number(p) > .5; }
+
+        const BVHTriangles &bvh;
+        const double beta;
+        std::vector<vec3> dipole;   // per node of bvh.tree, sum of the facet area times unit normal
+        std::vector<vec3> center;   // per node, area-weighted barycenter of the facets
+        std::vector<double> radius; // per node, radius of a ball around center enclosing its facets
+    };
+}
+
+#endif //__WINDING_NUMBER_H__
@@ -4,6 +4,7 @@
 #include <sstream>
 
 #include "ultimaille/io/geogram.h"
+#include "ultimaille/meter.h"
 #include <zlib/zlib.h>
 
 namespace UM {
@@ -112,6 +113,25 @@ namespace UM {
         }
     }
 
+    void write_geogram(const std::string filename, const CompactPointSet &ps) {
+        try {
+            GeogramGZWriter writer(filename);
+            writer.addFileHeader();
+            if (ps.storage==CompactPointSet::QUANTIZED16) { // the quantization frame precedes the quantized coordinates
+                const vec3 frame[2] = {ps.frame.min, ps.frame.max};
+                writer.addAttributeSize("UM::CompactPointSet::frame", 2);
+                writer.addAttribute("UM::CompactPointSet::frame", "frame", "double", reinterpret_cast<const double *>(frame), 2, 3);
+            }
+            writer.addAttributeSize("GEO::Mesh::vertices", ps.size());
+            if (ps.storage==CompactPointSet::FLOAT32)
+                writer.addAttribute("GEO::Mesh::vertices", "point_fp32", "float", ps.f32.data(), ps.size(), 3);
+            else
+                writer.addAttribute("GEO::Mesh::vertices", "point_q16", "uint16", ps.q16.data(), ps.size(), 3);
+        } catch (const std::exception& e) {
+            std::cerr << "Ooops: catch error= " << e.what() << " when creating " << filename << "\n";
+        }
+    }
+
     void write_geogram(const std::string filename, const PolyLine &pl, PolyLineAttributes attr) {
         try {
             GeogramGZWriter writer(filename);
@@ -452,11 +472,16 @@ namespace UM {
         }
 
         void read_attribute(void* addr, size_t size) {
+            read_attribute_part(addr, size);
+            check_chunk_size();
+        }
+
+        // N.B. call check_chunk_size() once the whole attribute is read
+        void read_attribute_part(void* addr, size_t size) {
             assert(current_chunk_class_ == "ATTR");
             int check = gzread(file_, addr, (unsigned int)(size));
             if (size_t(check) != size)
                 throw std::runtime_error("Could not read attribute  (" + std::to_string(check) + "/" + std::to_string(size) + " bytes read)");
-            check_chunk_size();
         }
 
         gzFile file_;
@@ -468,6 +493,8 @@ namespace UM {
     const std::string attrib_set_names[7] = {"GEO::Mesh::vertices", "GEO::Mesh::edges", "GEO::Mesh::facets", "GEO::Mesh::facet_corners", "GEO::Mesh::cells", "GEO::Mesh::cell_facets", "GEO::Mesh::cell_corners"};
     void read_geogram(const std::string filename, std::vector<NamedContainer> attr[7]) {
         int set_size[7] = {-1, -1, -1, -1, -1, -1, -1};
+        vec3 q16_frame[2] = {}; // quantization frame of the "point_q16" vertices, see write_geogram(CompactPointSet)
+        bool q16_frame_read = false;
         GeogramGZReader in(filename);
         std::string chunk_class;
         for (chunk_class=in.next_chunk(); chunk_class!="EOFL"; chunk_class=in.next_chunk()) {
@@ -481,6 +508,12 @@ namespace UM {
                         set_size[i] = nb_items;
             } else if (chunk_class == "ATTR") {
                 std::string attribute_set_name = in.read_string();
+                if (attribute_set_name == "UM::CompactPointSet::frame") {
+                    in.read_string(); in.read_string(); in.read_int(); in.read_int();
+                    in.read_attribute(q16_frame, sizeof(q16_frame));
+                    q16_frame_read = true;
+                    continue;
+                }
                 int nb_items = -1;
                 for (int i=0; i<7; i++)
                     if (attribute_set_name == attrib_set_names[i])
@@ -528,6 +561,22 @@ namespace UM {
                     GenericAttribute<vec3> A(nb_items);
                     in.read_attribute(std::dynamic_pointer_cast<AttributeContainer<vec3> >(A.ptr)->data.data(), size);
                     P = A.ptr;
+                } else if (element_type=="float" && 3==dimension) {
+                    std::vector<float> tmp(nb_items*3);
+                    in.read_attribute(tmp.data(), size);
+                    GenericAttribute<vec3> A(nb_items);
+                    for (int i=0; i<nb_items; i++)
+                        A[i] = {tmp[i*3], tmp[i*3+1], tmp[i*3+2]};
+                    P = A.ptr;
+                } else if (element_type=="uint16" && 3==dimension && attribute_set_name=="GEO::Mesh::vertices" && attribute_name=="point_q16") { // quantized coordinates
+                    if (!q16_frame_read) continue; // no frame to decode them
+                    CompactPointSet tmp(CompactPointSet::QUANTIZED16, BBox3(q16_frame[0], q16_frame[1]));
+                    tmp.q16.resize(size_t(3)*nb_items);
+                    in.read_attribute(tmp.q16.data(), size);
+                    GenericAttribute<vec3> A(nb_items);
+                    for (int i=0; i<nb_items; i++)
+                        A[i] = tmp[i];
+                    P = A.ptr;
                 } else if (element_type=="bool" && 1==dimension) {
                     std::vector<char> tmp(nb_items, 0);
                     in.read_attribute(tmp.data(), size);
@@ -547,7 +596,7 @@ namespace UM {
 
     void parse_pointset_attributes(PointSet &pts, std::vector<NamedContainer> &attr) {
         for (int i=0; i<(int)attr.size(); i++) {
-            if (attr[i].first != "point") continue;
+            if (attr[i].first != "point" && attr[i].first != "point_fp32" && attr[i].first != "point_q16") continue;
             std::shared_ptr<AttributeContainer<vec3> > ptr = std::dynamic_pointer_cast<AttributeContainer<vec3> >(attr[i].second);
             pts.resize(ptr->data.size());
             for (int v=0; v<pts.size(); v++)
@@ -778,5 +827,76 @@ namespace UM {
 
         return {attrib[0]};
     }
-}
 
+    // reads the nverts positions of the current attribute, stored as T[3] (float or double), without expanding them all to doubles
+    template <typename T> static void read_compact_vertices(GeogramGZReader &in, const int nverts, CompactPointSet &m) {
+        constexpr int chunk = 1<<16;
+        std::vector<T> tmp(3*chunk);
+        auto for_each_chunk = [&](auto f) {
+            for (int beg=0; beg<nverts; beg+=chunk) {
+                int n = std::min(chunk, nverts-beg);
+                in.read_attribute_part(tmp.data(), sizeof(T)*3*n);
+                for (int v=0; v<n; v++)
+                    f(beg+v, vec3(tmp[3*v], tmp[3*v+1], tmp[3*v+2]));
+            }
+        };
+        if (m.storage==CompactPointSet::QUANTIZED16 && m.frame.empty()) { // two passes: the first one computes the frame
+            const long start = gztell(in.file_);
+            for_each_chunk([&m](int, const vec3 &p) { m.frame.add(p); });
+            gzseek(in.file_, start, SEEK_SET);
+        }
+        m.resize(nverts);
+        for_each_chunk([&m](int v, const vec3 &p) { m.set(v, p); });
+        in.check_chunk_size();
+    }
+
+    void read_geogram(const std::string filename, CompactPointSet &m) {
+        m = CompactPointSet(m.storage, m.frame);
+        BBox3 file_frame;
+        GeogramGZReader in(filename);
+        int nverts = -1;
+        for (std::string chunk_class=in.next_chunk(); chunk_class!="EOFL"; chunk_class=in.next_chunk()) {
+            if (chunk_class == "ATTS") {
+                std::string attribute_set_name = in.read_string();
+                index_t nb_items = in.read_int();
+                in.check_chunk_size();
+                if (attribute_set_name == "GEO::Mesh::vertices")
+                    nverts = nb_items;
+            } else if (chunk_class == "ATTR") {
+                std::string attribute_set_name = in.read_string();
+                if (attribute_set_name != "GEO::Mesh::vertices" && attribute_set_name != "UM::CompactPointSet::frame") continue;
+                std::string attribute_name = in.read_string();
+                std::string element_type   = in.read_string();
+                index_t element_size = in.read_int();
+                index_t dimension    = in.read_int();
+                if (attribute_set_name == "UM::CompactPointSet::frame") {
+                    vec3 frame[2];
+                    in.read_attribute(frame, sizeof(frame));
+                    file_frame = BBox3(frame[0], frame[1]);
+                    continue;
+                }
+                if (attribute_name == "point_q16") { // the quantized coordinates are copied as is if the frames match
+                    um_assert(nverts>=0 && element_type=="uint16" && element_size*dimension == 6);
+                    CompactPointSet q16(CompactPointSet::QUANTIZED16, file_frame);
+                    q16.q16.resize(size_t(3)*nverts);
+                    in.read_attribute(q16.q16.data(), sizeof(std::uint16_t)*3*nverts);
+                    const bool same_frame = m.frame.empty() || ((m.frame.min-file_frame.min).norm2()==0 && (m.frame.max-file_frame.max).norm2()==0);
+                    if (m.storage==CompactPointSet::QUANTIZED16 && same_frame) {
+                        m = std::move(q16);
+                        continue;
+                    }
+                    m.resize(nverts);
+                    for (int v=0; v<nverts; v++)
+                        m.set(v, q16[v]);
+                    continue;
+                }
+                if (attribute_name != "point" && attribute_name != "point_fp32") continue;
+                um_assert(nverts>=0 && element_size*dimension == (element_type=="float" ? 12 : 24));
+                if (element_type=="float")
+                    read_compact_vertices<float>(in, nverts, m);
+                else
+                    read_compact_vertices<double>(in, nverts, m);
+            }
+        }
+    }
+}
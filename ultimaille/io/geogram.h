@@ -7,6 +7,7 @@
 #include "ultimaille/volume.h"
 #include "ultimaille/surface.h"
 #include "ultimaille/polyline.h"
+#include "ultimaille/compact_pointset.h"
 #include "ultimaille/attr_binding.h"
 
 namespace UM {
@@ -16,6 +17,11 @@ namespace UM {
     void write_geogram(const std::string filename, const Volume  &m,   const VolumeAttributes   attr = {{}, {}, {}, {}});
 
     PointSetAttributes read_geogram(const std::string filename, PointSet   &m);
+
+    // FLOAT32: single precision vertices ("point_fp32"), QUANTIZED16: the 16-bit integers ("point_q16") and their frame,
+    // the round trip is bit-exact; the coordinates are streamed without expansion to doubles
+    void write_geogram(const std::string filename, const CompactPointSet &ps);
+    void read_geogram(const std::string filename, CompactPointSet &m);
     PolyLineAttributes read_geogram(const std::string filename, PolyLine   &m);
     SurfaceAttributes  read_geogram(const std::string filename, Triangles  &m);
     SurfaceAttributes  read_geogram(const std::string filename, Quads      &m);
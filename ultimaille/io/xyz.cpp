@@ -20,8 +20,8 @@ namespace UM {
         out.close();
     }
 
-    PointSetAttributes read_xyz(const std::string filename, PointSet &m) {
-        m = PointSet();
+    // call f(p) for every point of a .xyz file
+    template <typename F> static void parse_xyz(const std::string filename, F f) {
         std::ifstream in;
         in.open(filename, std::ifstream::in);
         if (in.fail()) {
@@ -46,7 +46,7 @@ namespace UM {
                 iss.clear();
                 iss.seekg(0);
                 iss >> x >> y >> z;
-                m.push_back({x, y, z});
+                f(vec3{x, y, z});
             }
 
             if (nfields>6 || (nfields>0 && nfields<3 && !firstline))
@@ -55,7 +55,33 @@ namespace UM {
         }
 
         in.close();
+    }
+
+    PointSetAttributes read_xyz(const std::string filename, PointSet &m) {
+        m = PointSet();
+        parse_xyz(filename, [&m](const vec3 &p) { m.push_back(p); });
         return {};
     }
+
+    void write_xyz(const std::string filename, const CompactPointSet &ps) {
+        std::fstream out;
+        out.open(filename, std::ios_base::out);
+        if (out.fail()) {
+            throw std::runtime_error("Failed to open " + filename);
+        }
+        // N.B. the decoded quantized coordinates are doubles: printed with float precision, they would not quantize back to the same integers
+        out << std::setprecision(ps.storage==CompactPointSet::FLOAT32 ? std::numeric_limits<float>::max_digits10 : std::numeric_limits<double>::max_digits10);
+        for (vec3 p : ps)
+            out << p.x << " " << p.y << " " << p.z << std::endl;
+        out.close();
+    }
+
+    void read_xyz(const std::string filename, CompactPointSet &m) {
+        BBox3 frame = m.frame;
+        if (m.storage==CompactPointSet::QUANTIZED16 && frame.empty())
+            parse_xyz(filename, [&frame](const vec3 &p) { frame.add(p); });
+        m = CompactPointSet(m.storage, frame);
+        parse_xyz(filename, [&m](const vec3 &p) { m.push_back(p); });
+    }
 }
 
@@ -4,6 +4,7 @@
 #include <cstring>
 #include "ultimaille/attributes.h"
 #include "ultimaille/pointset.h"
+#include "ultimaille/compact_pointset.h"
 #include "ultimaille/polyline.h"
 #include "ultimaille/surface.h"
 #include "ultimaille/volume.h"
@@ -12,6 +13,12 @@
 namespace UM {
     void write_xyz(const std::string filename, const PointSet &ps);
     PointSetAttributes read_xyz(const std::string filename, PointSet &m);
+
+    // N.B. a QUANTIZED16 point set with an empty frame is read in two passes: the first one computes the frame
+    // The quantized coordinates are written as decoded doubles, they are read back exactly only with the same frame
+    // and if the decoded values are representable (extent not negligible w.r.t. the frame position); .geogram files store the integers
+    void write_xyz(const std::string filename, const CompactPointSet &ps);
+    void read_xyz(const std::string filename, CompactPointSet &m);
 }
 
 
@@ -0,0 +1,72 @@
+#ifndef __MEMORY_FOOTPRINT_H__
+#define __MEMORY_FOOTPRINT_H__
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <ostream>
+#include <iomanip>
+#include <algorithm>
+#include <type_traits>
+
+namespace UM {
+    // Heap memory consumed by a data structure, one item per component.
+    // used:     bytes occupied by the elements,
+    // reserved: bytes allocated, i.e. used + capacity slack.
+    // N.B. only the top-level buffers are accounted, memory owned by the elements themselves (e.g. std::string attributes) is not.
+    struct MemoryFootprint {
+        struct Item {
+            std::string name;
+            size_t used;
+            size_t reserved;
+        };
+
+        void add(const std::string &name, const size_t used, const size_t reserved) {
+            for (Item &item : items)
+                if (item.name == name) {
+                    item.used     += used;
+                    item.reserved += reserved;
+                    return;
+                }
+            items.push_back({name, used, reserved});
+        }
+
+        template <typename T> void add(const std::string &name, const std::vector<T> &v) {
+            if constexpr (std::is_same_v<T, bool>)
+                add(name, (v.size()+7)/8, (v.capacity()+7)/8);
+            else
+                add(name, v.size()*sizeof(T), v.capacity()*sizeof(T));
+        }
+
+        void add(const std::string &prefix, const MemoryFootprint &other) { // aggregate the items of a sub-structure
+            for (const Item &item : other.items)
+                add(prefix + item.name, item.used, item.reserved);
+        }
+
+        size_t used() const {
+            size_t sum = 0;
+            for (const Item &item : items) sum += item.used;
+            return sum;
+        }
+
+        size_t reserved() const {
+            size_t sum = 0;
+            for (const Item &item : items) sum += item.reserved;
+            return sum;
+        }
+
+        std::vector<Item> items = {};
+    };
+
+    inline std::ostream& operator<<(std::ostream& out, const MemoryFootprint &mf) {
+        size_t width = 5;
+        for (const MemoryFootprint::Item &item : mf.items)
+            width = std::max(width, item.name.size());
+        for (const MemoryFootprint::Item &item : mf.items)
+            out << std::left << std::setw(width) << item.name << std::right << std::setw(14) << item.used << " bytes used, " << std::setw(14) << item.reserved << " bytes reserved" << std::endl;
+        out << std::left << std::setw(width) << "total" << std::right << std::setw(14) << mf.used() << " bytes used, " << std::setw(14) << mf.reserved() << " bytes reserved" << std::endl;
+        return out;
+    }
+}
+
+#endif //__MEMORY_FOOTPRINT_H__
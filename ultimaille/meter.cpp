@@ -2,31 +2,218 @@
 #include <cmath>
 #include <cassert>
 #include <iostream>
+#include <algorithm>
+#include <array>
 
 #include "meter.h"
+#include "volume.h"
 #include "algebra/covariance.h"
 #include "algebra/eigen.h"
 
 namespace UM {
-    BBox3 Meter<PointSet>::bbox() const {
+    // Points is any range of vec3, e.g. PointSet or MappedArray<vec3>
+    template <class Points> static BBox3 points_bbox(const Points &pts) {
         BBox3 bbox;
         for (vec3 const &p : pts)
             bbox.add(p);
         return bbox;
     }
 
-    vec3 Meter<PointSet>::barycenter() const {
+    template <class Points> static vec3 points_barycenter(const Points &pts) {
         vec3 ave = {0, 0, 0};
         for (const vec3 &p : pts)
             ave += p;
         return ave / static_cast<double>(pts.size());
     }
 
+    BBox3 Meter<PointSet>::bbox() const {
+        return points_bbox(pts);
+    }
+
+    vec3 Meter<PointSet>::barycenter() const {
+        return points_barycenter(pts);
+    }
+
     std::tuple<mat3x3,vec3,vec3> Meter<PointSet>::principal_axes() const {
         PointSetCovariance cov(*pts.data);
         auto [eval, evec] = eigendecompose_symmetric(cov.cov);
         if (pts.size()<4) return {mat3x3::identity(), {1.,1.,1.}, cov.center}; // If the system is under-determined, return the trivial basis
         return { evec, eval, cov.center };
     }
-}
 
+    BBox3 Meter<CompactPointSet>::bbox() const {
+        BBox3 bbox;
+        if (!pts.size()) return bbox;
+        if (pts.storage==CompactPointSet::FLOAT32) {
+            float min[3], max[3];
+            for (int d : {0, 1, 2})
+                min[d] = max[d] = pts.f32[d];
+            for (int i=0; i<static_cast<int>(pts.f32.size()); i+=3)
+                for (int d : {0, 1, 2}) {
+                    min[d] = std::min(min[d], pts.f32[i+d]);
+                    max[d] = std::max(max[d], pts.f32[i+d]);
+                }
+            return { {min[0], min[1], min[2]}, {max[0], max[1], max[2]} };
+        }
+        std::uint16_t min[3] = {65535, 65535, 65535}, max[3] = {0, 0, 0};
+        for (int i=0; i<static_cast<int>(pts.q16.size()); i+=3)
+            for (int d : {0, 1, 2}) {
+                min[d] = std::min(min[d], pts.q16[i+d]);
+                max[d] = std::max(max[d], pts.q16[i+d]);
+            }
+        for (int d : {0, 1, 2}) {
+            double scale = (pts.frame.max[d]-pts.frame.min[d])/CompactPointSet::QMAX;
+            bbox.min[d] = pts.frame.min[d] + min[d]*scale;
+            bbox.max[d] = pts.frame.min[d] + max[d]*scale;
+        }
+        return bbox;
+    }
+
+    vec3 Meter<CompactPointSet>::barycenter() const {
+        return points_barycenter(pts);
+    }
+
+    // one-pass covariance over chunks of points, the chunks are merged with the Pebay formula
+    template <class Points> static std::tuple<mat3x3,vec3,vec3> chunked_principal_axes(const Points &pts) {
+        constexpr int chunk = 4096;
+        int nchunks = (pts.size()+chunk-1)/chunk;
+        std::vector<PointSetCovariance> partial(nchunks);
+#pragma omp parallel for
+        for (int c=0; c<nchunks; c++) {
+            PointSetCovariance &cov = partial[c];
+            int beg = c*chunk, end = std::min(pts.size(), beg+chunk);
+            cov.n = end-beg;
+            for (int i=beg; i<end; i++)
+                cov.center += pts[i];
+            cov.center /= static_cast<double>(cov.n);
+            for (int i=beg; i<end; i++) {
+                vec3 p = pts[i]-cov.center;
+                for (int j : {0, 1, 2})
+                    for (int k : {0, 1, 2})
+                        cov.cov[j][k] += p[j]*p[k];
+            }
+            cov.cov /= static_cast<double>(cov.n);
+        }
+        PointSetCovariance cov;
+        for (PointSetCovariance &p : partial)
+            cov = cov.n ? cov + p : p;
+        auto [eval, evec] = eigendecompose_symmetric(cov.cov);
+        if (pts.size()<4) return {mat3x3::identity(), {1.,1.,1.}, cov.center}; // If the system is under-determined, return the trivial basis
+        return { evec, eval, cov.center };
+    }
+
+    std::tuple<mat3x3,vec3,vec3> Meter<CompactPointSet>::principal_axes() const {
+        return chunked_principal_axes(pts);
+    }
+
+    BBox3 Meter<MappedArray<vec3> >::bbox() const {
+        return points_bbox(pts);
+    }
+
+    vec3 Meter<MappedArray<vec3> >::barycenter() const {
+        return points_barycenter(pts);
+    }
+
+    std::tuple<mat3x3,vec3,vec3> Meter<MappedArray<vec3> >::principal_axes() const {
+        return chunked_principal_axes(pts);
+    }
+
+    double Meter<MappedArray<vec3> >::area(const MappedArray<int> &triangles) const {
+        um_assert(triangles.size()%3 == 0);
+        const int nfacets = triangles.size()/3;
+        const int *v = triangles.data();
+        double sum = 0;
+#pragma omp parallel for reduction(+:sum)
+        for (int f=0; f<nfacets; f++)
+            sum += geo::unsigned_area(pts[v[3*f]], pts[v[3*f+1]], pts[v[3*f+2]]);
+        return sum;
+    }
+
+    std::vector<double> Meter<MappedArray<vec3> >::facet_areas(const MappedArray<int> &triangles) const {
+        um_assert(triangles.size()%3 == 0);
+        const int nfacets = triangles.size()/3;
+        const int *v = triangles.data();
+        std::vector<double> areas(nfacets);
+#pragma omp parallel for
+        for (int f=0; f<nfacets; f++)
+            areas[f] = geo::unsigned_area(pts[v[3*f]], pts[v[3*f+1]], pts[v[3*f+2]]);
+        return areas;
+    }
+
+    std::vector<vec3> Meter<MappedArray<vec3> >::facet_normals(const MappedArray<int> &triangles) const {
+        um_assert(triangles.size()%3 == 0);
+        const int nfacets = triangles.size()/3;
+        const int *v = triangles.data();
+        std::vector<vec3> normals(nfacets);
+#pragma omp parallel for
+        for (int f=0; f<nfacets; f++)
+            normals[f] = Triangle3(pts[v[3*f]], pts[v[3*f+1]], pts[v[3*f+2]]).normal();
+        return normals;
+    }
+
+    double Meter<MappedArray<vec3> >::volume(const MappedArray<int> &tets) const {
+        um_assert(tets.size()%4 == 0);
+        const int ncells = tets.size()/4;
+        const int *v = tets.data();
+        double sum = 0;
+#pragma omp parallel for reduction(+:sum)
+        for (int c=0; c<ncells; c++)
+            sum += geo::tet_volume(pts[v[4*c]], pts[v[4*c+1]], pts[v[4*c+2]], pts[v[4*c+3]]);
+        return sum;
+    }
+
+    std::vector<double> Meter<MappedArray<vec3> >::cell_volumes(const MappedArray<int> &tets) const {
+        um_assert(tets.size()%4 == 0);
+        const int ncells = tets.size()/4;
+        const int *v = tets.data();
+        std::vector<double> volumes(ncells);
+#pragma omp parallel for
+        for (int c=0; c<ncells; c++)
+            volumes[c] = geo::tet_volume(pts[v[4*c]], pts[v[4*c+1]], pts[v[4*c+2]], pts[v[4*c+3]]);
+        return volumes;
+    }
+
+    // the sides (edges of triangles or facets of tetrahedra) that are not shared by two elements, in the order of the elements
+    // N = corners per element, S = vertices per side, side(e, ls, k) is the k-th vertex of the side ls of the element e
+    template <int N, int S, class Side> static std::vector<int> unmatched_sides(const MappedArray<int> &elements, Side const &side) {
+        um_assert(elements.size()%N == 0);
+        constexpr int per_element = S==2 ? 3 : 4;
+        const int nsides = elements.size()/N*per_element;
+        std::vector<std::pair<std::array<int, S>, int> > sorted(nsides); // (sorted vertices, side id)
+#pragma omp parallel for
+        for (int i=0; i<nsides; i++) {
+            std::array<int, S> key;
+            for (int k=0; k<S; k++)
+                key[k] = side(i/per_element, i%per_element, k);
+            std::sort(key.begin(), key.end());
+            sorted[i] = {key, i};
+        }
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<int> unmatched;
+        for (int i=0; i<nsides; i++)
+            if ((i==0 || sorted[i-1].first!=sorted[i].first) && (i+1==nsides || sorted[i+1].first!=sorted[i].first))
+                unmatched.push_back(sorted[i].second);
+        std::sort(unmatched.begin(), unmatched.end());
+        return unmatched;
+    }
+
+    std::vector<int> Meter<MappedArray<vec3> >::boundary_edges(const MappedArray<int> &triangles) const {
+        const int *v = triangles.data();
+        auto side = [v](int f, int le, int k) { return v[3*f + (le+k)%3]; };
+        std::vector<int> edges;
+        for (int he : unmatched_sides<3, 2>(triangles, side))
+            for (int k : {0, 1})
+                edges.push_back(side(he/3, he%3, k));
+        return edges;
+    }
+
+    std::vector<int> Meter<MappedArray<vec3> >::boundary_facets(const MappedArray<int> &tets) const {
+        const int *v = tets.data();
+        auto side = [v](int c, int lf, int k) { return v[4*c + reference_cells[Volume::TETRAHEDRON].vert(lf, k)]; };
+        std::vector<int> facets;
+        for (int f : unmatched_sides<4, 3>(tets, side))
+            for (int k : {0, 1, 2})
+                facets.push_back(side(f/4, f%4, k));
+        return facets;
+    }
+}
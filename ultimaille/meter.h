@@ -5,6 +5,8 @@
 #include "algebra/mat.h"
 #include "helpers/hboxes.h"
 #include "pointset.h"
+#include "compact_pointset.h"
+#include "helpers/mapped_array.h"
 #include "surface.h"
 #include "syntactic-sugar/assert.h"
 
@@ -24,6 +26,39 @@ namespace UM {
         const PointSet& pts;
     };
 
+    // N.B. the kernels run on the compact representation, the point cloud is never expanded to doubles
+    template<> struct Meter<CompactPointSet> {
+        Meter(const CompactPointSet &pts) : pts(pts) {}
+
+        BBox3 bbox() const;
+        vec3 barycenter() const;
+        std::tuple<mat3x3,vec3,vec3> principal_axes() const;
+
+        const CompactPointSet& pts;
+    };
+
+    // N.B. the facet and cell kernels stream the mapped corner indices (e.g. Triangles::facets or Tetrahedra::cells
+    // written by write_mapped_array()), the elements are processed in parallel
+    template<> struct Meter<MappedArray<vec3> > {
+        Meter(const MappedArray<vec3> &pts) : pts(pts) {}
+
+        BBox3 bbox() const;
+        vec3 barycenter() const;
+        std::tuple<mat3x3,vec3,vec3> principal_axes() const;
+
+        double area(const MappedArray<int> &triangles) const;                // 3 corners per facet
+        std::vector<double> facet_areas(const MappedArray<int> &triangles) const;
+        std::vector<vec3> facet_normals(const MappedArray<int> &triangles) const;
+        double volume(const MappedArray<int> &tets) const;                   // 4 corners per cell, signed volumes
+        std::vector<double> cell_volumes(const MappedArray<int> &tets) const;
+
+        // boundary extraction, the elements are matched by sorting their sides: O(n log n) time, 16 bytes of RAM per side
+        std::vector<int> boundary_edges(const MappedArray<int> &triangles) const; // 2 vertices per border halfedge, oriented as in its facet
+        std::vector<int> boundary_facets(const MappedArray<int> &tets) const;     // 3 vertices per boundary facet, oriented as in Tetrahedra
+
+        const MappedArray<vec3>& pts;
+    };
+
     template<> struct Meter<Surface::Vertex> {
         Meter(const Surface::Vertex v) : v(v) {}
         int valence() {
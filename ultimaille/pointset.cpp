@@ -61,6 +61,30 @@ namespace UM {
         compress_attrs(old2new);
     }
 
+    Snapshot PointSet::snapshot() const {
+        Snapshot s;
+        s.points = save_buffer(*data, saved);
+        for (auto &wp : attr) if (auto spt = wp.lock())
+            s.attributes.emplace_back(wp, spt->save());
+        return s;
+    }
+
+    void PointSet::restore(const Snapshot &s) {
+        um_assert(s.points != nullptr);
+        restore_buffer(*data, *s.points);
+        for (auto &[wp, buffer] : s.attributes) if (auto spt = wp.lock())
+            spt->restore(buffer);
+        for (auto &wp : attr) if (auto spt = wp.lock()) // attributes created after the snapshot
+            spt->resize(size());
+    }
+
+    MemoryFootprint PointSet::memory_footprint() const {
+        MemoryFootprint mf;
+        mf.add("points", *data);
+        attributes_footprint(mf, "point attributes", attr);
+        return mf;
+    }
+
     void PointSet::resize_attrs() {
         um_assert(1==data.use_count());
         for (auto &wp : attr)  if (auto spt = wp.lock())
@@ -6,6 +6,8 @@
 #include "algebra/vec.h"
 #include "algebra/mat.h"
 #include "helpers/hboxes.h"
+#include "snapshot.h"
+#include "memory_footprint.h"
 
 namespace UM {
     struct GenericAttributeContainer;
@@ -27,6 +29,11 @@ namespace UM {
         const vec3& operator[](const int i) const { return data->at(i); }
         int use_count() { return data.use_count(); }
 
+        Snapshot snapshot() const;
+        void restore(const Snapshot &s);
+
+        MemoryFootprint memory_footprint() const; // the points and the point attributes
+
         void resize(const int n);
         int push_back(const vec3 &p);
         void delete_points(const std::vector<bool> &to_kill, std::vector<int> &old2new); // TODO: remove old2new
@@ -45,6 +52,7 @@ namespace UM {
 
         std::shared_ptr<std::vector<vec3> > data;
         std::vector<std::weak_ptr<GenericAttributeContainer> > attr = {};
+        mutable std::weak_ptr<const std::vector<vec3> > saved = {}; // last snapshot of the points
     };
 }
 
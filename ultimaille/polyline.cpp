@@ -38,6 +38,37 @@ namespace UM {
             spt->resize(nedges());
     }
 
+    Snapshot PolyLine::snapshot() const {
+        Snapshot s = points.snapshot();
+        s.elements = save_buffer(edges, edges_saved);
+        for (auto &wp : attr) if (auto spt = wp.lock())
+            s.attributes.emplace_back(wp, spt->save());
+        return s;
+    }
+
+    void PolyLine::restore(const Snapshot &s) {
+        um_assert(s.elements != nullptr);
+        bool topology_changed = restore_buffer(edges, *s.elements);
+        points.restore(s); // N.B. restores all the attributes, not only the point ones
+        resize_attrs();    // attributes created after the snapshot
+        if (topology_changed && connected())
+            conn->init();
+    }
+
+    MemoryFootprint PolyLine::memory_footprint() const {
+        MemoryFootprint mf;
+        std::vector<const GenericAttributeContainer *> internal;
+        if (connected())
+            internal = { conn->v2e.ptr.get(), conn->e2e.ptr.get(), conn->active.ptr.get() };
+        mf.add("points", *points.data);
+        mf.add("edges", edges);
+        for (auto *ptr : internal)
+            ptr->memory_footprint(mf, "connectivity");
+        attributes_footprint(mf, "point attributes", points.attr, internal);
+        attributes_footprint(mf, "edge attributes", attr, internal);
+        return mf;
+    }
+
     void PolyLine::compress_attrs(const std::vector<bool> &edges_to_kill) {
         assert(edges_to_kill.size()==(size_t)nedges());
         std::vector<int>  edges_old2new(nedges(),  -1);
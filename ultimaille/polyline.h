@@ -16,6 +16,7 @@ namespace UM {
         PointSet points{};
         std::vector<int> edges{};
         std::vector<std::weak_ptr<GenericAttributeContainer> > attr{};
+        mutable std::weak_ptr<const std::vector<int> > edges_saved{}; // last snapshot of the edges
 
         int nverts() const;
         int nedges() const;
@@ -38,6 +39,12 @@ namespace UM {
 
         void delete_isolated_vertices();
 
+        // cheap checkpointing, see Snapshot
+        Snapshot snapshot() const;
+        void restore(const Snapshot &s);
+
+        MemoryFootprint memory_footprint() const; // the mesh, its connectivity and all its attributes
+
         PolyLine() {}
         PolyLine(const PolyLine& m) {
             um_assert(!m.points.size() && !m.edges.size());
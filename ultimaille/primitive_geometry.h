@@ -131,6 +131,7 @@ namespace UM {
         vec3 grad(vec3 u) const;
         inline mat3x3 as_matrix() const;
         inline vec3 nearest_point(const vec3 &p) const;
+        inline vec3 nearest_point(const vec3 &p, int &feature) const; // feature: vertex i (0..2), edge v[i]v[i+1] (3+i) or interior (6)
 
         inline vec3& operator[](int i) { return v[i]; }
         inline vec3 operator[](int i)const { return v[i]; }
@@ -160,6 +161,7 @@ namespace UM {
         inline vec3 bary_verts() const;
         double unsigned_area() const;
         inline Quad2 xy() const;
+        inline vec3 nearest_point(const vec3 &p) const; // on the two triangles v0v1v2 and v0v2v3, i.e. the quad split along the diagonal v0v2
 
         inline vec3& operator[](int i) { return v[i]; }
         inline vec3 operator[](int i) const { return v[i]; }
@@ -185,6 +187,8 @@ namespace UM {
         vec4 bary_coords(vec3 G) const;
         mat<3,4> grad_operator() const;
         vec3 grad(vec4 u) const;
+        inline bool contains(const vec3 &p) const;      // inside or on the boundary, false for a flat tetrahedron
+        inline vec3 nearest_point(const vec3 &p) const; // p itself if it is inside, the nearest point on the boundary otherwise
 
         inline vec3& operator[](int i) { return v[i]; }
         inline vec3 operator[](int i) const { return v[i]; }
@@ -312,39 +316,63 @@ namespace UM {
     }
 
     inline vec3 Triangle3::nearest_point(const vec3 &p) const {
+        int feature;
+        return nearest_point(p, feature);
+    }
+
+    //      3    .
+    //         .
+    //    ...c
+    //       ..
+    //       . .   6
+    //       .  .
+    //    5  . 0 .     .
+    //       .    .  .
+    //    ...a.....b
+    //       .     .  2
+    //     1 .  4  .
+    //       .     .
+    inline vec3 Triangle3::nearest_point(const vec3 &p, int &feature) const {
         vec3 ab = v[1] - v[0];
         vec3 ac = v[2] - v[0];
         vec3 ap = p - v[0];
 
         double d1 = ab*ap;
-        double d2 = ac*ap;                       //                            3    .
-        if (d1 <= 0 && d2 <= 0) return v[0];     // region 1, vertex a            .
-                                                 //                          ...c
-        vec3 bp = p - v[1];                      //                             ..
-        double d3 = ab*bp;                       //                             . .   6
-        double d4 = ac*bp;                       //                             .  .
-        if (d3 >= 0 && d4 <= d3) return v[1];    // region 2, vertex b       5  . 0 .     .
-                                                 //                             .    .  .
-        vec3 cp = p - v[2];                      //                          ...a.....b
-        double d5 = ab*cp;                       //                             .     .  2
-        double d6 = ac*cp;                       //                           1 .  4  .
-        if (d6 >= 0 && d5 <= d6) return v[2];    // region 3, vertex c          .     .
+        double d2 = ac*ap;
+        if (d1 <= 0 && d2 <= 0) { feature = 0; return v[0]; }  // region 1, vertex a
+
+        vec3 bp = p - v[1];
+        double d3 = ab*bp;
+        double d4 = ac*bp;
+        if (d3 >= 0 && d4 <= d3) { feature = 1; return v[1]; }  // region 2, vertex b
+
+        vec3 cp = p - v[2];
+        double d5 = ab*cp;
+        double d6 = ac*cp;
+        if (d6 >= 0 && d5 <= d6) { feature = 2; return v[2]; }  // region 3, vertex c
 
         double vc = d1 * d4 - d3 * d2;
-        if (vc <= 0 && d1 >= 0 && d3 <= 0)
+        if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+            feature = 3;
             return v[0] + ab * (d1 / (d1 - d3)); // region 4, edge ab
+        }
 
         double vb = d5 * d2 - d1 * d6;
-        if (vb <= 0 && d2 >= 0 && d6 <= 0)
+        if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+            feature = 5;
             return v[0] + ac * (d2 / (d2 - d6)); // region 5, edge ac
+        }
 
         double va = d3 * d6 - d5 * d4;
-        if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) // region 6, edge bc
+        if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) { // region 6, edge bc
+            feature = 4;
             return v[1] + (v[2] - v[1]) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        }
 
         double denom = 1 / (va + vb + vc);
         double t = vb * denom;
         double s = vc * denom;
+        feature = 6;
         return v[0] + t * ab + s * ac;           // region 0, triangle abc
     }
 
@@ -370,10 +398,37 @@ namespace UM {
         return (v[0] + v[1] + v[2] + v[3]) / 4;
     }
 
+    inline vec3 Quad3::nearest_point(const vec3 &p) const {
+        vec3 p1 = Triangle3(v[0], v[1], v[2]).nearest_point(p);
+        vec3 p2 = Triangle3(v[0], v[2], v[3]).nearest_point(p);
+        return (p1-p).norm2() < (p2-p).norm2() ? p1 : p2;
+    }
+
     inline double Tetrahedron::volume() const {
         return geo::tet_volume(v[0], v[1], v[2], v[3]);
     }
 
+    inline bool Tetrahedron::contains(const vec3 &p) const {
+        double vol = volume();
+        if (vol == 0) return false;
+        for (int i=0; i<4; i++) { // p must be on the same side as v[i] of the opposite facet
+            Tetrahedron t = *this;
+            t.v[i] = p;
+            if (t.volume()*vol < 0) return false;
+        }
+        return true;
+    }
+
+    inline vec3 Tetrahedron::nearest_point(const vec3 &p) const {
+        if (contains(p)) return p;
+        vec3 best = v[0];
+        for (int i=0; i<4; i++) {
+            vec3 q = Triangle3(v[(i+1)%4], v[(i+2)%4], v[(i+3)%4]).nearest_point(p);
+            if ((q-p).norm2() < (best-p).norm2()) best = q;
+        }
+        return best;
+    }
+
     inline Quad3 Pyramid::base() const {
         return Quad3(v[0], v[1], v[2], v[3]);
     }
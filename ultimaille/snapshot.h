@@ -0,0 +1,51 @@
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <utility>
+#include <concepts>
+#include <type_traits>
+#include "algebra/vec.h"
+
+namespace UM {
+    struct GenericAttributeContainer;
+
+    // State of a mesh saved by snapshot() and brought back by restore().
+    // The point, element and attribute arrays are shared with the previous snapshot, they are duplicated only if they were modified since.
+    // The mesh never shares its buffers with a snapshot, so that writing to it (e.g. from a parallel loop) never has to check for a copy.
+    struct Snapshot {
+        std::shared_ptr<const std::vector<vec3> > points = {};
+        std::shared_ptr<const std::vector<int> > elements = {}; // edges, facets or cells
+        std::shared_ptr<const std::vector<int> > offset = {};   // Polygons only
+        std::vector<std::pair<std::weak_ptr<GenericAttributeContainer>, std::shared_ptr<const void> > > attributes = {};
+    };
+
+    template <typename T> bool same_buffer_content(const std::vector<T> &a, const std::vector<T> &b) {
+        if (a.size()!=b.size()) return false;
+        if constexpr (std::is_trivially_copyable_v<T> && !std::is_same_v<T, bool>)
+            return !a.size() || !std::memcmp(a.data(), b.data(), sizeof(T)*a.size());
+        else if constexpr (std::equality_comparable<T>)
+            return a==b;
+        return false;
+    }
+
+    // return an immutable copy of v; if v did not change since the last call, the last copy is returned instead
+    template <typename T> std::shared_ptr<const std::vector<T> > save_buffer(const std::vector<T> &v, std::weak_ptr<const std::vector<T> > &last) {
+        if (auto spt = last.lock(); spt && same_buffer_content(*spt, v))
+            return spt;
+        auto spt = std::make_shared<const std::vector<T> >(v);
+        last = spt;
+        return spt;
+    }
+
+    // bring back a saved buffer, return true if v was modified
+    template <typename T> bool restore_buffer(std::vector<T> &v, const std::vector<T> &saved) {
+        if (same_buffer_content(v, saved)) return false;
+        v = saved;
+        return true;
+    }
+}
+
+#endif //__SNAPSHOT_H__
@@ -1,6 +1,7 @@
 #ifndef __LINEXPR_H__
 #define __LINEXPR_H__
 
+#include <algorithm>
 #include "vector.h"
 
 namespace UM {
@@ -34,6 +35,53 @@ namespace UM {
         return v * a;
     }
 
+    // Accumulation of a linear expression: the terms are appended as is, whereas LinExpr::operator+= sorts and merges
+    // the whole expression after each operation (k terms cost O(k log k) instead of O(k^2 log k)).
+    // The expression is compacted once, when the builder is converted to a LinExpr, e.g. when it is passed to add_to_energy().
+    // The coefficients of a variable are summed in insertion order, the result is the same as with repeated +=,
+    // unless a partial sum falls below SparseElement::TOL (+= would drop it).
+    struct LinExprBuilder {
+        LinExprBuilder& operator+=(const LinExpr& e) {
+            terms.insert(terms.end(), e.begin(), e.end());
+            return *this;
+        }
+
+        LinExprBuilder& operator-=(const LinExpr& e) {
+            for (const SparseElement &t : e)
+                terms.push_back(-t);
+            return *this;
+        }
+
+        LinExprBuilder& add(const LinExpr& e, double c) { // same as += e*c
+            for (const SparseElement &t : e)
+                if (!(t*c).is_null()) // N.B. e*c drops the null terms
+                    terms.push_back(t*c);
+            return *this;
+        }
+
+        operator LinExpr() const { // N.B. stable sort: the coefficients of a variable are summed in insertion order
+            SparseVector v;
+            v.data = terms;
+            std::stable_sort(v.begin(), v.end(), [](const SparseElement& a, const SparseElement& b) { return a.index < b.index; });
+            int s = 0;
+            for (int i=0; i<v.size(); ) {
+                v.data[s] = v.data[i++];
+                while (i<v.size() && v.data[i].index == v.data[s].index)
+                    v.data[s].value += v.data[i++].value;
+                if (!v.data[s].is_null())
+                    s++;
+            }
+            v.data.resize(s);
+            return LinExpr(std::move(v));
+        }
+
+        void reserve(int n) { terms.reserve(n); }
+        void clear() { terms.clear(); }
+        int size() const { return terms.size(); } // number of terms before compaction
+
+        std::vector<SparseElement> terms = {};
+    };
+
     namespace Linear {
         inline LinExpr X(int i) { return {{i, 1.}}; }
     }
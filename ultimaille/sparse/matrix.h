@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include "vector.h"
+#include "ultimaille/memory_footprint.h"
 
 namespace UM {
     // read-only compressed row storage matrix
@@ -27,6 +28,13 @@ namespace UM {
             return wrapper{ mat.begin() + offset[i], mat.begin() + offset[i+1] };
         }
 
+        MemoryFootprint memory_footprint() const {
+            MemoryFootprint mf;
+            mf.add("values", mat);
+            mf.add("offset", offset);
+            return mf;
+        }
+
         std::vector<SparseElement> mat = {};
         std::vector<int> offset = { 0 };
     };
@@ -53,6 +61,14 @@ namespace UM {
         int count_columns() const;
         int count_nnz() const;
 
+        MemoryFootprint memory_footprint() const {
+            MemoryFootprint mf;
+            mf.add("rows", rows);
+            for (const SparseVector &row : rows)
+                mf.add("values", row.data);
+            return mf;
+        }
+
         std::vector<SparseVector> rows = {};
     };
 
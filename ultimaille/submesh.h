@@ -0,0 +1,104 @@
+#ifndef __SUBMESH_H__
+#define __SUBMESH_H__
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <concepts>
+#include "surface.h"
+#include "volume.h"
+
+namespace UM {
+    // Zero-copy view over a subset of the facets of a Surface or of the cells of a Volume.
+    // The view only stores the local-to-global maps of its elements and vertices (sorted by global index),
+    // everything else, including the attributes, is read from (and written to) the parent mesh.
+    // The view is invalidated by any change of the parent topology.
+    template <class M> struct SubMeshView {
+        static_assert(std::derived_from<M, Surface> || std::derived_from<M, Volume>);
+        static constexpr bool is_surface = std::derived_from<M, Surface>;
+
+        SubMeshView(M &m, std::vector<int> subset) : m(m), elements(std::move(subset)) {
+            std::sort(elements.begin(), elements.end());
+            elements.erase(std::unique(elements.begin(), elements.end()), elements.end());
+            um_assert(elements.empty() || (elements.front()>=0 && elements.back()<nparent_elements()));
+            for (int e : elements)
+                for (int lv=0; lv<element_size_global(e); lv++)
+                    vertices.push_back(m.vert(e, lv));
+            std::sort(vertices.begin(), vertices.end());
+            vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+        }
+
+        int nverts()    const { return vertices.size(); }
+        int nelements() const { return elements.size(); }
+        int nfacets()   const requires is_surface { return nelements(); }
+        int ncells()    const requires (!is_surface) { return nelements(); }
+
+        // local to global and global to local maps, local_element() and local_vertex() return -1 if the element (the vertex) is not in the view
+        int element(const int i) const { assert(i>=0 && i<nelements()); return elements[i]; }
+        int vertex (const int i) const { assert(i>=0 && i<nverts());    return vertices[i]; }
+        int local_element(const int g) const { return find(elements, g); }
+        int local_vertex (const int g) const { return find(vertices, g); }
+
+        int element_size(const int i) const { return element_size_global(elements[i]); }
+        int vert(const int i, const int lv) const { return m.vert(elements[i], lv); }    // global vertex index
+        int local_vert(const int i, const int lv) const { return local_vertex(vert(i, lv)); }
+
+        vec3 &point(const int i) { return m.points[vertices[i]]; }
+        const vec3 &point(const int i) const { return m.points[vertices[i]]; }
+
+        // attribute of the parent mesh indexed by the local element (vertex) indices, the data is not copied
+        template <class A> struct LocalAttribute {
+            A &attr;
+            const std::vector<int> &l2g;
+            decltype(auto) operator[](const int i)       { return attr[l2g[i]]; }
+            decltype(auto) operator[](const int i) const { return std::as_const(attr)[l2g[i]]; }
+            int size() const { return l2g.size(); }
+        };
+        template <class A> LocalAttribute<A> per_element(A &attr) const { return { attr, elements }; }
+        template <class A> LocalAttribute<A> per_vertex (A &attr) const { return { attr, vertices }; }
+
+        // iterate over the primitives of the parent mesh that belong to the view
+        auto iter_vertices() { return iter_primitives<typename M::Vertex>(vertices); }
+        auto iter_facets() requires is_surface   { return iter_primitives<typename M::Facet>(elements); }
+        auto iter_cells()  requires (!is_surface) { return iter_primitives<typename M::Cell>(elements); }
+
+        M &m;
+        std::vector<int> elements = {}; // local to global facet/cell map
+        std::vector<int> vertices = {}; // local to global vertex map
+
+    protected:
+        int nparent_elements() const {
+            if constexpr (is_surface) return m.nfacets();
+            else return m.ncells();
+        }
+
+        int element_size_global(const int e) const {
+            if constexpr (is_surface) return m.facet_size(e);
+            else return m.nverts_per_cell();
+        }
+
+        static int find(const std::vector<int> &sorted, const int g) {
+            auto it = std::lower_bound(sorted.begin(), sorted.end(), g);
+            return it!=sorted.end() && *it==g ? static_cast<int>(it-sorted.begin()) : -1;
+        }
+
+        template <class P> auto iter_primitives(const std::vector<int> &l2g) {
+            struct iterator {
+                M &m;
+                std::vector<int>::const_iterator it;
+                void operator++() { ++it; }
+                bool operator!=(const iterator& rhs) const { return it != rhs.it; }
+                P operator*() const { return P(m, *it); }
+            };
+            struct wrapper {
+                M &m;
+                const std::vector<int> &l2g;
+                auto begin() { return iterator{ m, l2g.begin() }; }
+                auto end()   { return iterator{ m, l2g.end()   }; }
+            };
+            return wrapper{ m, l2g };
+        }
+    };
+}
+
+#endif //__SUBMESH_H__
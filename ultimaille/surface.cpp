@@ -117,6 +117,43 @@ namespace UM {
         delete_vertices(to_kill);
     }
 
+    Snapshot Surface::snapshot() const {
+        Snapshot s = points.snapshot();
+        s.elements = save_buffer(facets, facets_saved);
+        for (auto *attr : {&attr_facets, &attr_corners})
+            for (auto &wp : *attr) if (auto spt = wp.lock())
+                s.attributes.emplace_back(wp, spt->save());
+        return s;
+    }
+
+    bool Surface::restore_facets(const Snapshot &s) {
+        um_assert(s.elements != nullptr);
+        bool topology_changed = restore_buffer(facets, *s.elements);
+        points.restore(s); // N.B. restores all the attributes, not only the point ones
+        resize_attrs();    // attributes created after the snapshot
+        return topology_changed;
+    }
+
+    void Surface::restore(const Snapshot &s) {
+        if (restore_facets(s) && connected())
+            conn->init();
+    }
+
+    MemoryFootprint Surface::memory_footprint() const {
+        MemoryFootprint mf;
+        std::vector<const GenericAttributeContainer *> internal;
+        if (connected())
+            internal = { conn->v2c.ptr.get(), conn->c2f.ptr.get(), conn->c2c.ptr.get(), conn->active.ptr.get() };
+        mf.add("points", *points.data);
+        mf.add("facets", facets);
+        for (auto *ptr : internal)
+            ptr->memory_footprint(mf, "connectivity");
+        attributes_footprint(mf, "point attributes",  points.attr,  internal);
+        attributes_footprint(mf, "facet attributes",  attr_facets,  internal);
+        attributes_footprint(mf, "corner attributes", attr_corners, internal);
+        return mf;
+    }
+
     void Surface::resize_attrs() {
         for (auto &wp : attr_facets)  if (auto spt = wp.lock())
             spt->resize(nfacets());
@@ -206,6 +243,26 @@ namespace UM {
         return nfacets()-n;
     }
 
+    Snapshot Polygons::snapshot() const {
+        Snapshot s = Surface::snapshot();
+        s.offset = save_buffer(offset, offset_saved);
+        return s;
+    }
+
+    void Polygons::restore(const Snapshot &s) {
+        um_assert(s.offset != nullptr);
+        bool topology_changed = restore_buffer(offset, *s.offset);
+        topology_changed = restore_facets(s) || topology_changed;
+        if (topology_changed && connected())
+            conn->init();
+    }
+
+    MemoryFootprint Polygons::memory_footprint() const {
+        MemoryFootprint mf = Surface::memory_footprint();
+        mf.add("offset", offset);
+        return mf;
+    }
+
     void Polygons::delete_facets(const std::vector<bool> &to_kill) {
         assert(!connected());
         Surface::delete_facets(to_kill); // TODO: if to_kill comes from an attribute, Surface::delete_facets compacts it, thus compromising the code below
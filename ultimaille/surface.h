@@ -16,6 +16,7 @@ namespace UM {
         std::vector<int> facets{};
         std::vector<std::weak_ptr<GenericAttributeContainer> > attr_facets{};
         std::vector<std::weak_ptr<GenericAttributeContainer> > attr_corners{};
+        mutable std::weak_ptr<const std::vector<int> > facets_saved{}; // last snapshot of the facets
 
 ////////////////////////////////////////////////////
 //       _                 _                _     //
@@ -48,6 +49,15 @@ namespace UM {
             disconnect();
         }
 
+        // cheap checkpointing, see Snapshot
+        virtual Snapshot snapshot() const;
+        virtual void restore(const Snapshot &s);
+        protected:
+        bool restore_facets(const Snapshot &s); // restore() but the connectivity, true if the facets changed
+        public:
+
+        virtual MemoryFootprint memory_footprint() const; // the mesh, its connectivity and all its attributes
+
         Surface() = default;
         Surface(const Surface& m) {
             um_assert(!m.points.size() && !m.facets.size());
@@ -250,6 +260,12 @@ namespace UM {
             offset = { 0 };
         }
 
+        Snapshot snapshot() const;
+        void restore(const Snapshot &s);
+        mutable std::weak_ptr<const std::vector<int> > offset_saved{};
+
+        MemoryFootprint memory_footprint() const;
+
         int nfacets()  const;
         int facet_size(const int fi) const;
         int corner(const int fi, const int ci) const;
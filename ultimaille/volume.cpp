@@ -18,6 +18,37 @@ namespace UM {
             spt->resize(ncorners());
     }
 
+    Snapshot Volume::snapshot() const {
+        Snapshot s = points.snapshot();
+        s.elements = save_buffer(cells, cells_saved);
+        for (auto *attr : {&attr_cells, &attr_facets, &attr_corners})
+            for (auto &wp : *attr) if (auto spt = wp.lock())
+                s.attributes.emplace_back(wp, spt->save());
+        return s;
+    }
+
+    void Volume::restore(const Snapshot &s) {
+        um_assert(s.elements != nullptr);
+        bool topology_changed = restore_buffer(cells, *s.elements);
+        points.restore(s); // N.B. restores all the attributes, not only the point ones
+        resize_attrs();    // attributes created after the snapshot
+        if (topology_changed && connected())
+            conn->reset();
+    }
+
+    MemoryFootprint Volume::memory_footprint() const {
+        MemoryFootprint mf;
+        mf.add("points", *points.data);
+        mf.add("cells", cells);
+        if (connected())
+            mf.add("connectivity", conn->oppf.adjacent);
+        attributes_footprint(mf, "point attributes",       points.attr);
+        attributes_footprint(mf, "cell attributes",        attr_cells);
+        attributes_footprint(mf, "cell facet attributes",  attr_facets);
+        attributes_footprint(mf, "cell corner attributes", attr_corners);
+        return mf;
+    }
+
     void Volume::compress_attrs(const std::vector<bool> &cells_to_kill) {
         assert(cells_to_kill.size()==(size_t)ncells());
         std::vector<int>   cells_old2new(ncells(),   -1);
@@ -83,6 +83,7 @@ namespace UM {
         std::vector<std::weak_ptr<GenericAttributeContainer> > attr_cells{};
         std::vector<std::weak_ptr<GenericAttributeContainer> > attr_facets{};
         std::vector<std::weak_ptr<GenericAttributeContainer> > attr_corners{};
+        mutable std::weak_ptr<const std::vector<int> > cells_saved{}; // last snapshot of the cells
 
         int  create_cells(const int n);
         void delete_cells(const std::vector<bool> &to_kill);
@@ -116,6 +117,12 @@ namespace UM {
             attr_corners = {};
         }
 
+        // cheap checkpointing, see Snapshot
+        Snapshot snapshot() const;
+        void restore(const Snapshot &s);
+
+        MemoryFootprint memory_footprint() const; // the mesh, its connectivity and all its attributes
+
         Volume(CELL_TYPE cell_type) : cell_type(cell_type) {}
         Volume(const Volume& m) { // TODO re-think copying policy
             um_assert(!m.points.size() && !m.cells.size());